@@ -0,0 +1,70 @@
+// Copyright (c) 2025 Manuel Schneider
+
+#include "corpus.h"
+#include <QDir>
+#include <QFile>
+#include <QRandomGenerator>
+#include <QStringList>
+#include <cmath>
+using namespace Qt::StringLiterals;
+using namespace std;
+
+static const QStringList ascii_words{
+    u"deploy"_s, u"server"_s, u"kubectl"_s, u"ssh"_s, u"regards"_s, u"invoice"_s,
+    u"meeting"_s, u"0x7f3a"_s, u"localhost"_s, u"password"_s, u"signature"_s, u"docker"_s,
+    u"SELECT"_s, u"FROM"_s, u"WHERE"_s, u"git"_s, u"rebase"_s, u"--force"_s, u"TODO"_s
+};
+
+static const QStringList unicode_words{
+    u"Grüße"_s, u"straße"_s, u"日本語"_s, u"東京"_s, u"Привет"_s, u"спасибо"_s,
+    u"مرحبا"_s, u"ελληνικά"_s, u"😀"_s, u"🚀"_s, u"naïve"_s, u"café"_s
+};
+
+static const QString &word(QRandomGenerator &rng, double unicode_ratio)
+{
+    const auto &words = rng.generateDouble() < unicode_ratio ? unicode_words : ascii_words;
+    return words[rng.bounded(words.size())];
+}
+
+QString randomText(QRandomGenerator &rng, qsizetype size, bool newlines)
+{
+    QString text;
+    text.reserve(size + 16);
+    while (text.size() < size)
+    {
+        text += word(rng, 0.2);
+        text += newlines && rng.bounded(8) == 0 ? u'\n' : u' ';
+    }
+    return text;
+}
+
+void writeCorpus(const QString &dir, const CorpusOptions &o)
+{
+    QDir().mkpath(dir);
+    QRandomGenerator rng(o.seed);
+
+    for (int i = 0; i < o.count; ++i)
+    {
+        // Pareto distributed size, shape 1.2, scale 64 bytes
+        const auto u = 1.0 - rng.generateDouble();  // (0, 1]
+        const auto size = min<qsizetype>(o.max_size, qsizetype(64.0 / pow(u, 1.0 / 1.2)));
+
+        auto name = u"%1 %2 %3"_s.arg(word(rng, o.unicode_name_ratio),
+                                      word(rng, o.unicode_name_ratio))
+                        .arg(i);
+
+        const bool long_line = rng.generateDouble() < o.long_line_ratio;
+        auto bytes = randomText(rng, size, !long_line).toUtf8();
+
+        if (rng.generateDouble() < o.crlf_ratio)
+            bytes.replace("\n", "\r\n");
+
+        if (rng.generateDouble() < o.invalid_utf8_ratio)
+            for (const char *seq : {"\xC3\x28", "\xFF", "\xE2\x82"})
+                bytes.insert(rng.bounded(bytes.size() + 1), seq);
+
+        QFile file(QDir(dir).filePath(name.remove(u'/') + u".txt"_s));
+        if (!file.open(QIODevice::WriteOnly) || file.write(bytes) != bytes.size())
+            qFatal("Failed to write %s", qPrintable(file.fileName()));
+    }
+}
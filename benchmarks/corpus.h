@@ -0,0 +1,29 @@
+// Copyright (c) 2025 Manuel Schneider
+
+#pragma once
+#include <QString>
+class QRandomGenerator;
+
+struct CorpusOptions
+{
+    int count = 1000;
+    quint32 seed = 42;
+    qsizetype max_size = 16 * 1024 * 1024;  // Bytes
+    double unicode_name_ratio = 0.3;
+    double crlf_ratio = 0.1;
+    double long_line_ratio = 0.02;
+    double invalid_utf8_ratio = 0.01;
+};
+
+///
+/// Writes a synthetic snippet corpus to `dir`.
+///
+/// File sizes follow a Pareto distribution, i.e. most snippets are small and
+/// few are huge. Names and contents mix ASCII and non-Latin scripts. Some
+/// files use CRLF line endings, consist of a single long line or contain
+/// invalid UTF-8. The output depends on the options only.
+///
+void writeCorpus(const QString &dir, const CorpusOptions &options);
+
+/// Returns about `size` characters of words from a mixed-script vocabulary.
+QString randomText(QRandomGenerator &rng, qsizetype size, bool newlines = true);
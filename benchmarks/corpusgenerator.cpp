@@ -0,0 +1,52 @@
+// Copyright (c) 2025 Manuel Schneider
+
+#include "corpus.h"
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QStandardPaths>
+using namespace Qt::StringLiterals;
+
+int main(int argc, char **argv)
+{
+    QCoreApplication app(argc, argv);
+
+    const auto default_location =
+        QStandardPaths::writableLocation(QStandardPaths::GenericConfigLocation)
+        + u"/albert/snippets"_s;
+
+    const CorpusOptions d;
+    QCommandLineParser parser;
+    parser.setApplicationDescription(
+        u"Writes a deterministic synthetic snippet corpus to <dir>. "
+        "The plugin reads snippets from %1."_s.arg(default_location));
+    parser.addHelpOption();
+    parser.addPositionalArgument(u"dir"_s, u"The output directory."_s);
+    parser.addOptions({
+        {u"count"_s, u"Number of snippets."_s, u"n"_s, QString::number(d.count)},
+        {u"seed"_s, u"Random seed."_s, u"n"_s, QString::number(d.seed)},
+        {u"max-size"_s, u"Maximum snippet size in bytes."_s, u"n"_s, QString::number(d.max_size)},
+        {u"unicode-names"_s, u"Ratio of non-ASCII name words."_s, u"r"_s,
+         QString::number(d.unicode_name_ratio)},
+        {u"crlf"_s, u"Ratio of CRLF files."_s, u"r"_s, QString::number(d.crlf_ratio)},
+        {u"long-lines"_s, u"Ratio of single line files."_s, u"r"_s,
+         QString::number(d.long_line_ratio)},
+        {u"invalid-utf8"_s, u"Ratio of files containing invalid UTF-8."_s, u"r"_s,
+         QString::number(d.invalid_utf8_ratio)}
+    });
+    parser.process(app);
+
+    if (parser.positionalArguments().size() != 1)
+        parser.showHelp(1);
+
+    writeCorpus(parser.positionalArguments().front(), {
+        .count = parser.value(u"count"_s).toInt(),
+        .seed = parser.value(u"seed"_s).toUInt(),
+        .max_size = parser.value(u"max-size"_s).toLongLong(),
+        .unicode_name_ratio = parser.value(u"unicode-names"_s).toDouble(),
+        .crlf_ratio = parser.value(u"crlf"_s).toDouble(),
+        .long_line_ratio = parser.value(u"long-lines"_s).toDouble(),
+        .invalid_utf8_ratio = parser.value(u"invalid-utf8"_s).toDouble()
+    });
+
+    return 0;
+}
@@ -0,0 +1,319 @@
+// Copyright (c) 2025 Manuel Schneider
+
+#include "contentindex.h"
+#include "corpus.h"
+#include "preview.h"
+#include "snippetpack.h"
+#include "snippetreader.h"
+#include "snippetscanner.h"
+#include "snippetstore.h"
+#include "snippettemplate.h"
+#include "trigramindex.h"
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRandomGenerator>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QThread>
+#include <QThreadPool>
+#include <QtConcurrentRun>
+#include <albert/logging.h>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <numeric>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+ALBERT_LOGGING_CATEGORY("snippets.benchmark")
+using namespace Qt::StringLiterals;
+using namespace std;
+
+static const IndexLimits limits{256 * 1024, 16 * 1024};
+
+// Wall time statistics of the samples in `ns`
+static QJsonObject statistics(const QString &name, vector<qint64> ns)
+{
+    const auto repetitions = int(ns.size());
+    sort(ns.begin(), ns.end());
+
+    return {
+        {u"name"_s, name},
+        {u"repetitions"_s, repetitions},
+        {u"min_ns"_s, ns.front()},
+        {u"median_ns"_s, ns[ns.size() / 2]},
+        {u"mean_ns"_s, accumulate(ns.begin(), ns.end(), qint64(0)) / qint64(ns.size())},
+        {u"max_ns"_s, ns.back()}
+    };
+}
+
+// Runs `f` `repetitions` times and returns the wall time statistics
+static QJsonObject measure(const QString &name, int repetitions, const function<void()> &f)
+{
+    vector<qint64> ns;
+    QElapsedTimer timer;
+    for (int i = 0; i < repetitions; ++i)
+    {
+        timer.start();
+        f();
+        ns.push_back(timer.nsecsElapsed());
+    }
+    return statistics(name, ::move(ns));
+}
+
+static void writeFile(const QString &path, const QString &text)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly) || file.write(text.toUtf8()) < 0)
+        qFatal("Failed to write %s", qPrintable(path));
+}
+
+// Heap bytes in use, -1 if unknown
+static qint64 heapUsage()
+{
+#ifdef __GLIBC__
+    return qint64(mallinfo2().uordblks);
+#else
+    return -1;
+#endif
+}
+
+// Heap bytes held by the result of `make`, which is destroyed afterwards
+template<class F>
+static QJsonObject measureMemory(const QString &name, qsizetype count, F make)
+{
+    const auto before = heapUsage();
+    auto result = make();
+    const auto bytes = before < 0 ? -1 : heapUsage() - before;
+    return {
+        {u"name"_s, name},
+        {u"items"_s, count},
+        {u"bytes"_s, bytes},
+        {u"bytes_per_item"_s, bytes < 0 ? -1. : double(bytes) / double(count)}
+    };
+}
+
+// The previous item layout: one heap allocated item per snippet
+struct LegacyItem
+{
+    virtual ~LegacyItem() = default;
+    QString id;
+    mutex preview_mutex;
+    QString preview;
+    bool preview_read;
+    void *plugin;
+};
+
+// The store layout: views into a SnippetStore in one vector
+struct StoreItem
+{
+    StoreItem(const void *i, quint32 n) : items(i), index(n) {}
+    virtual ~StoreItem() = default;
+    const void *items;
+    quint32 index;
+};
+
+// The plugin's cold scan, without entries to reuse. Empty if aborted.
+static IndexTable scan(const QString &dir, const IndexLimits &l = limits,
+                       const bool &abort = false)
+{
+    const ScanContext context{dir, l, QThreadPool::globalInstance()};
+    auto result = scanSnippetFiles(context, listSnippetFiles(context, {QString()}, abort),
+                                   {}, {}, abort);
+    return result ? ::move(result->table) : IndexTable{};
+}
+
+int main(int argc, char **argv)
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(u"Snippets plugin benchmarks. Prints JSON results."_s);
+    parser.addHelpOption();
+    parser.addOption({u"output"_s, u"Write the results to <file>."_s, u"file"_s});
+    parser.addOption({u"max-files"_s, u"Largest scan corpus, default 100000."_s, u"n"_s, u"100000"_s});
+    parser.addOption({u"repetitions"_s, u"Repetitions per scenario, default 5."_s, u"n"_s, u"5"_s});
+    parser.process(app);
+
+    const auto max_files = parser.value(u"max-files"_s).toInt();
+    const auto repetitions = max(1, parser.value(u"repetitions"_s).toInt());
+
+    QJsonArray results;
+
+    // Cold scans
+    for (const auto count : {1000, 10000, 100000})
+    {
+        if (count > max_files)
+            break;
+
+        QTemporaryDir dir;
+        writeCorpus(dir.path(), {.count = count});
+        results.append(measure(u"cold_scan_%1"_s.arg(count), repetitions,
+                               [&]{ scan(dir.path()); }));
+
+        // The same corpus as a single pack
+        vector<pair<QString, QByteArray>> entries;
+        for (QDirIterator it(dir.path(), {u"*.txt"_s}, QDir::Files); it.hasNext();)
+        {
+            QFile file(it.next());
+            file.open(QIODevice::ReadOnly);
+            entries.emplace_back(it.fileInfo().completeBaseName(), file.readAll());
+        }
+        QTemporaryDir pack_dir;
+        writeSnippetPack(pack_dir.filePath(u"corpus"_s + SnippetPack::suffix), ::move(entries));
+        results.append(measure(u"cold_scan_pack_%1"_s.arg(count), repetitions,
+                               [&]{ scan(pack_dir.path()); }));
+    }
+
+    // Ranking
+    {
+        QTemporaryDir dir;
+        writeCorpus(dir.path(), {.count = min(10000, max_files)});
+
+        vector<ContentIndex::Document> documents;
+        vector<TrigramIndex::Document> texts;
+        for (auto &[file_name, entry] : scan(dir.path()))
+        {
+            documents.push_back({nullptr, entry.terms});
+            texts.push_back({nullptr, entry.text});
+        }
+        const ContentIndex content_index(documents);
+        const TrigramIndex trigram_index(texts, 64 * 1024 * 1024);
+
+        for (const auto &query : {u"dep"_s, u"deploy"_s, u"deploy serv"_s, u"7f3"_s, u"host"_s})
+        {
+            results.append(measure(u"rank_words '%1'"_s.arg(query), repetitions * 20,
+                                   [&]{ content_index.search(query); }));
+            results.append(measure(u"rank_substring '%1'"_s.arg(query), repetitions * 20,
+                                   [&]{ trigram_index.search(query); }));
+        }
+
+        // Keystrokes narrowing the matches of the previous query, see Plugin::rankItems
+        for (const auto &keystroke : {pair(u"dep"_s, u"depl"_s),
+                                      pair(u"deplo"_s, u"deploy"_s),
+                                      pair(u"deploy"_s, u"deploy s"_s),
+                                      pair(u"deploy s"_s, u"deploy serv"_s)})
+        {
+            const auto &query = keystroke.second;
+            const auto words = content_index.match(keystroke.first);
+            const auto substrings = trigram_index.match(keystroke.first);
+            results.append(measure(u"rank_words_narrowed '%1'"_s.arg(query), repetitions * 20,
+                                   [&]{ content_index.match(query, words ? &*words : nullptr); }));
+            results.append(measure(u"rank_substring_narrowed '%1'"_s.arg(query), repetitions * 20,
+                                   [&]{ trigram_index.match(query, substrings ? &*substrings : nullptr); }));
+        }
+    }
+
+    // Memory footprint of the items and their index strings
+    {
+        const auto count = min(100000, max_files);
+        QRandomGenerator rng(42);
+        vector<SnippetStore::Snippet> snippets;
+        for (int i = 0; i < count; ++i)
+            snippets.push_back({u"folder%1/snippet-%2"_s.arg(i % 32).arg(i),
+                                randomText(rng, 100, false).simplified()});
+
+        results.append(measureMemory(u"memory_legacy_items"_s, count, [&]{
+            vector<pair<shared_ptr<LegacyItem>, QString>> index;
+            index.reserve(snippets.size());
+            for (const auto &s : snippets)
+            {
+                auto item = make_shared<LegacyItem>();
+                item->id = QString(s.id.data(), s.id.size());  // Deep copies
+                item->preview = QString(s.preview.data(), s.preview.size());
+                item->preview_read = true;
+                auto name = item->id.sliced(item->id.lastIndexOf(u'/') + 1);
+                index.emplace_back(::move(item), ::move(name));
+            }
+            return index;
+        }));
+
+        results.append(measureMemory(u"memory_store_items"_s, count, [&]{
+            struct Items
+            {
+                Items(const vector<SnippetStore::Snippet> &s) : store(s) {}
+                SnippetStore store;
+                vector<StoreItem> items;
+            };
+            auto items = make_shared<Items>(snippets);
+            items->items.reserve(items->store.size());
+            for (qsizetype i = 0; i < items->store.size(); ++i)
+                items->items.emplace_back(items.get(), quint32(i));
+
+            vector<pair<shared_ptr<StoreItem>, QString>> index;
+            index.reserve(snippets.size());
+            for (qsizetype i = 0; i < items->store.size(); ++i)
+                index.emplace_back(shared_ptr<StoreItem>(items, &items->items[i]),
+                                   items->store.name(i));
+            return index;
+        }));
+    }
+
+    // Item construction and clipboard reads by file size
+    {
+        QTemporaryDir dir;
+        QRandomGenerator rng(42);
+        for (const auto size : {1 << 10, 1 << 16, 1 << 20, 1 << 24})
+        {
+            const auto path = u"%1/%2.txt"_s.arg(dir.path()).arg(size);
+            writeFile(path, randomText(rng, size));
+            results.append(measure(u"item_construction_%1"_s.arg(size), repetitions,
+                                   [&]{ readIndexData(path, limits); }));
+            results.append(measure(u"preview_read_%1"_s.arg(size), repetitions, [&]{
+                QFile file(path);
+                file.open(QIODevice::ReadOnly);
+                readPreview(file, 100);
+            }));
+            results.append(measure(u"copy_read_%1"_s.arg(size), repetitions,
+                                   [&]{ readSnippet(path); }));
+
+            // A placeholder every 4 KiB
+            auto text = randomText(rng, size);
+            for (qsizetype i = 0; i < text.size(); i += 4096)
+                text.insert(i, i % 8192 ? u"{date:yyyy-MM-dd}"_s : u"{env:HOME}"_s);
+            const SnippetTemplate tmpl(text);
+            results.append(measure(u"template_compile_%1"_s.arg(size), repetitions,
+                                   [&]{ SnippetTemplate{text}; }));
+            results.append(measure(u"template_expand_%1"_s.arg(size), repetitions,
+                                   [&]{ tmpl.expand({}); }));
+        }
+    }
+
+    // Time from setting the abort flag until a scan of large files returns
+    {
+        QTemporaryDir dir;
+        QRandomGenerator rng(42);
+        for (int i = 0; i < 2 * QThread::idealThreadCount(); ++i)
+            writeFile(u"%1/%2.txt"_s.arg(dir.path()).arg(i), randomText(rng, 1 << 24));
+
+        const IndexLimits unbounded{numeric_limits<qsizetype>::max(), 16 * 1024};
+        vector<qint64> ns;
+        QElapsedTimer timer;
+        for (int i = 0; i < repetitions; ++i)
+        {
+            bool abort = false;
+            auto future = QtConcurrent::run([&]{ scan(dir.path(), unbounded, abort); });
+            QThread::msleep(20);
+            timer.start();
+            abort = true;
+            future.waitForFinished();
+            ns.push_back(timer.nsecsElapsed());
+        }
+        results.append(statistics(u"abort_latency"_s, ::move(ns)));
+    }
+
+    const auto json = QJsonDocument(results).toJson();
+    if (parser.isSet(u"output"_s))
+        writeFile(parser.value(u"output"_s), QString::fromUtf8(json));
+    else
+        QTextStream(stdout) << json;
+
+    return 0;
+}
@@ -19,6 +19,22 @@
         <source>Open snippet dir</source>
         <translation>Schnipselverzeichnis öffnen</translation>
     </message>
+    <message>
+        <source>Write the indexer timings since the last time to the log.</source>
+        <translation>Indexierzeiten seit dem letzten Mal ins Protokoll schreiben.</translation>
+    </message>
+    <message>
+        <source>Log timings</source>
+        <translation>Zeiten protokollieren</translation>
+    </message>
+    <message>
+        <source>Import the snippet files into the database.</source>
+        <translation>Schnipseldateien in die Datenbank importieren.</translation>
+    </message>
+    <message>
+        <source>Import to database</source>
+        <translation>In Datenbank importieren</translation>
+    </message>
 </context>
 <context>
     <name>FilenameDialog</name>
@@ -93,5 +109,29 @@
         <source>Failed to read snippet file &apos;%1&apos;. Error: %2</source>
         <translation>Lesen der Schnipseldatei &apos;%1&apos; fehlgeschlagen. Fehler: %2</translation>
     </message>
+    <message>
+        <source>Failed to import the snippets into the database.</source>
+        <translation>Importieren der Schnipsel in die Datenbank fehlgeschlagen.</translation>
+    </message>
+    <message>
+        <source>Failed to store the snippet &apos;%1&apos; in the database.</source>
+        <translation>Speichern des Schnipsels &apos;%1&apos; in der Datenbank fehlgeschlagen.</translation>
+    </message>
+    <message>
+        <source>Delete snippet &apos;%1&apos; from the database?</source>
+        <translation>Schnipsel &apos;%1&apos; aus der Datenbank löschen?</translation>
+    </message>
+    <message>
+        <source>Reading snippet &apos;%1&apos;…</source>
+        <translation>Lese Schnipsel &apos;%1&apos;…</translation>
+    </message>
+    <message>
+        <source>Cancel</source>
+        <translation>Abbrechen</translation>
+    </message>
+    <message>
+        <source>Not found in the database.</source>
+        <translation>Nicht in der Datenbank gefunden.</translation>
+    </message>
 </context>
 </TS>
@@ -19,6 +19,22 @@
         <source>Open snippet dir</source>
         <translation></translation>
     </message>
+    <message>
+        <source>Write the indexer timings since the last time to the log.</source>
+        <translation></translation>
+    </message>
+    <message>
+        <source>Log timings</source>
+        <translation></translation>
+    </message>
+    <message>
+        <source>Import the snippet files into the database.</source>
+        <translation></translation>
+    </message>
+    <message>
+        <source>Import to database</source>
+        <translation></translation>
+    </message>
 </context>
 <context>
     <name>FilenameDialog</name>
@@ -93,5 +109,29 @@
         <source>Failed to read snippet file &apos;%1&apos;. Error: %2</source>
         <translation></translation>
     </message>
+    <message>
+        <source>Failed to import the snippets into the database.</source>
+        <translation></translation>
+    </message>
+    <message>
+        <source>Failed to store the snippet &apos;%1&apos; in the database.</source>
+        <translation></translation>
+    </message>
+    <message>
+        <source>Delete snippet &apos;%1&apos; from the database?</source>
+        <translation></translation>
+    </message>
+    <message>
+        <source>Reading snippet &apos;%1&apos;…</source>
+        <translation></translation>
+    </message>
+    <message>
+        <source>Cancel</source>
+        <translation></translation>
+    </message>
+    <message>
+        <source>Not found in the database.</source>
+        <translation></translation>
+    </message>
 </context>
 </TS>
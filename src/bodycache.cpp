@@ -0,0 +1,93 @@
+// Copyright (c) 2025 Manuel Schneider
+
+#include "bodycache.h"
+#include "snippettemplate.h"
+using namespace std;
+
+void BodyCache::setBudget(qsizetype bytes)
+{
+    lock_guard lock(mutex_);
+    budget_ = bytes;
+    evict();
+}
+
+shared_ptr<const SnippetTemplate> BodyCache::get(const QString &path, const FileStamp &stamp)
+{
+    lock_guard lock(mutex_);
+    if (const auto it = entries_.constFind(path); it != entries_.cend())
+    {
+        if (it.value()->stamp == stamp)
+        {
+            ++hits_;
+            lru_.splice(lru_.begin(), lru_, it.value());
+            return lru_.front().body;
+        }
+        erase(it.value());  // Stale
+    }
+    ++misses_;
+    return {};
+}
+
+void BodyCache::put(const QString &path, const FileStamp &stamp,
+                    shared_ptr<const SnippetTemplate> body)
+{
+    lock_guard lock(mutex_);
+
+    if (const auto it = entries_.constFind(path); it != entries_.cend())
+        erase(it.value());
+
+    const auto cost = body->memoryUsage();
+    if (cost > budget_)
+        return;
+
+    lru_.push_front({path, stamp, ::move(body), cost});
+    entries_.insert(path, lru_.begin());
+    bytes_ += cost;
+    evict();
+}
+
+void BodyCache::remove(const QString &path)
+{
+    lock_guard lock(mutex_);
+    if (const auto it = entries_.constFind(path); it != entries_.cend())
+        erase(it.value());
+}
+
+void BodyCache::clear()
+{
+    lock_guard lock(mutex_);
+    lru_.clear();
+    entries_.clear();
+    bytes_ = 0;
+}
+
+quint64 BodyCache::hits() const
+{
+    lock_guard lock(mutex_);
+    return hits_;
+}
+
+quint64 BodyCache::misses() const
+{
+    lock_guard lock(mutex_);
+    return misses_;
+}
+
+qsizetype BodyCache::bytes() const
+{
+    lock_guard lock(mutex_);
+    return bytes_;
+}
+
+void BodyCache::erase(list<Entry>::iterator it)
+{
+    bytes_ -= it->cost;
+    entries_.remove(it->path);
+    lru_.erase(it);
+}
+
+void BodyCache::evict()
+{
+    while (bytes_ > budget_ && !lru_.empty())
+        erase(prev(lru_.end()));
+}
@@ -0,0 +1,59 @@
+// Copyright (c) 2025 Manuel Schneider
+
+#pragma once
+#include "filestamp.h"
+#include <QHash>
+#include <QString>
+#include <list>
+#include <memory>
+#include <mutex>
+class SnippetTemplate;
+
+///
+/// Size bounded LRU cache of compiled snippet bodies keyed by path.
+///
+/// Entries are valid for the file stamp they were put with only. Thread-safe.
+///
+class BodyCache
+{
+public:
+
+    /// Sets the maximum memory used by the cached bodies in bytes.
+    void setBudget(qsizetype bytes);
+
+    /// Returns the body of `path` if cached for `stamp`, otherwise null.
+    std::shared_ptr<const SnippetTemplate> get(const QString &path, const FileStamp &stamp);
+
+    void put(const QString &path, const FileStamp &stamp,
+             std::shared_ptr<const SnippetTemplate> body);
+
+    void remove(const QString &path);
+    void clear();
+
+    quint64 hits() const;
+    quint64 misses() const;
+    qsizetype bytes() const;
+
+private:
+
+    void evict();
+
+    struct Entry
+    {
+        QString path;
+        FileStamp stamp;
+        std::shared_ptr<const SnippetTemplate> body;
+        qsizetype cost;
+    };
+
+    void erase(std::list<Entry>::iterator it);
+
+    mutable std::mutex mutex_;
+    std::list<Entry> lru_;  // Most recently used first
+    QHash<QString, std::list<Entry>::iterator> entries_;
+    qsizetype budget_ = 0;
+    qsizetype bytes_ = 0;
+    quint64 hits_ = 0;
+    quint64 misses_ = 0;
+
+};
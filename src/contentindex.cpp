@@ -0,0 +1,236 @@
+// Copyright (c) 2025 Manuel Schneider
+
+#include "contentindex.h"
+#include <QHash>
+#include <QSet>
+#include <algorithm>
+#include <albert/item.h>
+using namespace albert;
+using namespace std;
+
+namespace
+{
+
+const qsizetype min_term_length = 2;
+const qsizetype max_term_length = 64;  // Longer words are most likely encoded data
+
+const qsizetype abort_check_interval = 64 * 1024;  // Characters
+
+// Returns the first element of the sorted [first, last) not less than
+// `value`, probing exponentially growing steps before the binary search.
+// O(log distance), cheap for the short skips of a merge.
+template<class It, class T, class Less>
+It gallop(It first, It last, const T &value, Less less)
+{
+    qsizetype step = 1;
+    while (last - first > step && less(first[step], value))
+    {
+        first += step;
+        step *= 2;
+    }
+    return lower_bound(first, first + min<qsizetype>(step + 1, last - first), value, less);
+}
+
+// Calls `f` for each word of `text`. Returns false if aborted.
+template<class F>
+bool forEachWord(const QString &text, F f, const bool *abort = nullptr)
+{
+    qsizetype begin = -1;
+    for (qsizetype i = 0; i <= text.size(); ++i)
+    {
+        if (abort && i % abort_check_interval == 0 && *abort)
+            return false;
+
+        if (i < text.size() && (text[i].isLetterOrNumber() || text[i] == u'_'))
+        {
+            if (begin < 0)
+                begin = i;
+        }
+        else if (begin >= 0)
+        {
+            if (const auto len = i - begin; min_term_length <= len && len <= max_term_length)
+                f(QStringView(text).sliced(begin, len));
+            begin = -1;
+        }
+    }
+    return true;
+}
+
+QStringList words(const QString &text)
+{
+    QStringList words;
+    forEachWord(text, [&](QStringView w){ words << w.toString().toLower(); });
+    return words;
+}
+
+}
+
+ContentIndex::ContentIndex(const vector<Document> &documents)
+{
+    QHash<QByteArrayView, vector<quint32>> postings;
+
+    items_.reserve(documents.size());
+    for (quint32 id = 0; id < documents.size(); ++id)
+    {
+        items_.push_back(documents[id].item);
+
+        const QByteArrayView terms(documents[id].terms);
+        for (qsizetype b = 0, e; b < terms.size(); b = e + 1)
+        {
+            if (e = terms.indexOf('\n', b); e < 0)
+                e = terms.size();
+            postings[terms.sliced(b, e - b)].push_back(id);  // Ids ascend
+        }
+    }
+
+    vector<QByteArrayView> terms;
+    terms.reserve(postings.size());
+    for (auto it = postings.cbegin(); it != postings.cend(); ++it)
+        terms.push_back(it.key());
+    sort(terms.begin(), terms.end());
+
+    term_offsets_.reserve(terms.size() + 1);
+    posting_offsets_.reserve(terms.size() + 1);
+    term_offsets_.push_back(0);
+    posting_offsets_.push_back(0);
+    for (const auto &t : terms)
+    {
+        term_arena_.append(t);
+        term_offsets_.push_back(term_arena_.size());
+
+        const auto &p = *postings.constFind(t);
+        postings_.insert(postings_.end(), p.begin(), p.end());
+        posting_offsets_.push_back(postings_.size());
+    }
+
+    term_arena_.squeeze();
+    postings_.shrink_to_fit();
+}
+
+QByteArray ContentIndex::terms(const QString &text, const bool *abort)
+{
+    // Deduplicate while scanning, then sort the vocabulary only
+    QSet<QString> unique;
+    if (!forEachWord(text, [&](QStringView w){ unique.insert(w.toString().toLower()); }, abort))
+        return {};
+
+    QStringList list(unique.begin(), unique.end());
+    list.sort();
+    return list.join(u'\n').toUtf8();
+}
+
+QByteArrayView ContentIndex::term(qsizetype i) const
+{
+    return QByteArrayView(term_arena_).sliced(term_offsets_[i],
+                                              term_offsets_[i + 1] - term_offsets_[i]);
+}
+
+optional<ContentIndex::Matches> ContentIndex::match(const QString &query,
+                                                    const Matches *candidates) const
+{
+    Matches matches;
+    bool first = true;
+
+    for (const auto &word : words(query))
+    {
+        if (word.size() < min_query_word_length)
+            continue;
+
+        const auto w = word.toUtf8();
+
+        // Lower bound of the terms having the prefix w
+        qsizetype lo = 0, hi = qsizetype(term_offsets_.size()) - 1;
+        while (lo < hi)
+            if (const auto mid = (lo + hi) / 2; term(mid) < QByteArrayView(w))
+                lo = mid + 1;
+            else
+                hi = mid;
+
+        // Union of the postings, keep the best match per document
+        vector<pair<quint32, double>> hits;
+        for (auto i = lo; i < qsizetype(term_offsets_.size()) - 1 && term(i).startsWith(w); ++i)
+        {
+            const auto score = double(w.size()) / term(i).size();
+            const auto begin = postings_.begin() + posting_offsets_[i];
+            const auto end = postings_.begin() + posting_offsets_[i + 1];
+            if (!candidates)
+                for (auto p = begin; p != end; ++p)
+                    hits.emplace_back(*p, score);
+            else if (end - begin < qsizetype(candidates->size()))
+            {
+                // Walk the shorter side and gallop through the longer one
+                auto c = candidates->begin();
+                for (auto p = begin; p != end; ++p)
+                {
+                    c = gallop(c, candidates->end(), *p,
+                               [](const auto &m, quint32 id){ return m.first < id; });
+                    if (c == candidates->end())
+                        break;
+                    if (c->first == *p)
+                        hits.emplace_back(*p, score);
+                }
+            }
+            else
+            {
+                auto p = begin;
+                for (const auto &c : *candidates)
+                {
+                    p = gallop(p, end, c.first, std::less<>());
+                    if (p == end)
+                        break;
+                    if (*p == c.first)
+                        hits.emplace_back(c.first, score);
+                }
+            }
+        }
+        sort(hits.begin(), hits.end(),
+             [](const auto &a, const auto &b){ return a.first < b.first
+                                                      || (a.first == b.first && a.second > b.second); });
+        hits.erase(unique(hits.begin(), hits.end(),
+                          [](const auto &a, const auto &b){ return a.first == b.first; }),
+                   hits.end());
+
+        // Intersection with the previous words, keep the worst match per document
+        if (first)
+        {
+            matches = ::move(hits);
+            first = false;
+        }
+        else
+        {
+            vector<pair<quint32, double>> intersection;
+            auto h = hits.begin();
+            for (const auto &[id, score] : matches)
+            {
+                h = lower_bound(h, hits.end(), id,
+                                [](const auto &hit, quint32 v){ return hit.first < v; });
+                if (h == hits.end())
+                    break;
+                if (h->first == id)
+                    intersection.emplace_back(id, min(score, h->second));
+            }
+            matches = ::move(intersection);
+        }
+
+        if (matches.empty())
+            break;
+    }
+
+    if (first)
+        return {};
+    return matches;
+}
+
+vector<pair<shared_ptr<Item>, double>> ContentIndex::search(const QString &query) const
+{
+    vector<pair<shared_ptr<Item>, double>> results;
+    if (const auto matches = match(query))
+    {
+        results.reserve(matches->size());
+        for (const auto &[id, score] : *matches)
+            results.emplace_back(items_[id], score);
+    }
+    return results;
+}
+
+const shared_ptr<Item> &ContentIndex::item(quint32 id) const { return items_[id]; }
@@ -0,0 +1,65 @@
+// Copyright (c) 2025 Manuel Schneider
+
+#pragma once
+#include <QByteArray>
+#include <QString>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+namespace albert { class Item; }
+
+///
+/// Immutable inverted index over the words of the snippet contents.
+///
+/// Terms are lowercase UTF-8 words stored back to back in a single arena and
+/// sorted, each referencing a slice of one flat posting array of document
+/// ids. Queries match every query word as prefix of a term.
+///
+class ContentIndex
+{
+public:
+
+    struct Document
+    {
+        std::shared_ptr<albert::Item> item;
+        QByteArray terms;  // As returned by terms()
+    };
+
+    explicit ContentIndex(const std::vector<Document> &documents);
+
+    /// Returns the sorted unique terms of `text`, joined by '\n'.
+    ///
+    /// Checks `abort` periodically, if set, and returns nothing if aborted.
+    static QByteArray terms(const QString &text, const bool *abort = nullptr);
+
+    /// Document ids and scores, sorted by id.
+    using Matches = std::vector<std::pair<quint32, double>>;
+
+    /// Returns the documents containing all words of `query` with a score in (0, 1].
+    ///
+    /// Returns nothing if no word of `query` is long enough to be looked up.
+    /// If set, only the `candidates` are considered, e.g. the matches of a
+    /// query that `query` extends.
+    std::optional<Matches> match(const QString &query, const Matches *candidates = nullptr) const;
+
+    /// Returns the items containing all words of `query` with a score in (0, 1].
+    std::vector<std::pair<std::shared_ptr<albert::Item>, double>> search(const QString &query) const;
+
+    /// Returns the item of the document `id`.
+    const std::shared_ptr<albert::Item> &item(quint32 id) const;
+
+    /// Query words shorter than this are not looked up.
+    static constexpr qsizetype min_query_word_length = 3;
+
+private:
+
+    QByteArrayView term(qsizetype i) const;
+
+    QByteArray term_arena_;
+    std::vector<quint32> term_offsets_;  // terms + 1
+    std::vector<quint32> posting_offsets_;  // terms + 1
+    std::vector<quint32> postings_;
+    std::vector<std::shared_ptr<albert::Item>> items_;
+
+};
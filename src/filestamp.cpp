@@ -0,0 +1,25 @@
+// Copyright (c) 2025 Manuel Schneider
+
+#include "filestamp.h"
+#include <QFile>
+#include <sys/stat.h>
+using namespace std;
+
+optional<FileStamp> FileStamp::of(const QString &path)
+{
+    struct stat st;
+    if (::stat(QFile::encodeName(path).constData(), &st) != 0)
+        return {};
+
+#if defined(Q_OS_MACOS)
+    const auto &ts = st.st_mtimespec;
+#else
+    const auto &ts = st.st_mtim;
+#endif
+
+    return FileStamp{
+        .size = static_cast<qint64>(st.st_size),
+        .mtime = static_cast<qint64>(ts.tv_sec) * 1'000'000'000 + ts.tv_nsec,
+        .inode = static_cast<quint64>(st.st_ino)
+    };
+}
@@ -0,0 +1,16 @@
+// Copyright (c) 2025 Manuel Schneider
+
+#pragma once
+#include <QString>
+#include <optional>
+
+struct FileStamp
+{
+    qint64 size = 0;
+    qint64 mtime = 0;  // Nanoseconds since epoch
+    quint64 inode = 0;
+
+    bool operator==(const FileStamp &) const = default;
+
+    static std::optional<FileStamp> of(const QString &path);
+};
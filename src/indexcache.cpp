@@ -0,0 +1,199 @@
+// Copyright (c) 2025 Manuel Schneider
+
+#include "indexcache.h"
+#include <QFile>
+#include <QSaveFile>
+#include <albert/logging.h>
+#include <cstring>
+using namespace std;
+
+namespace
+{
+
+struct Header
+{
+    char magic[4];
+    quint32 version;
+    quint32 count;
+    quint32 blob_size;  // UTF-16 code units
+    quint32 bytes_size;  // Terms and texts
+    quint32 reserved;
+};
+
+struct Record
+{
+    qint64 size;
+    qint64 mtime;
+    quint64 inode;
+    quint32 name_offset;
+    quint32 name_length;
+    quint32 preview_offset;
+    quint32 preview_length;
+    quint32 terms_offset;
+    quint32 terms_length;
+    quint32 text_offset;
+    quint32 text_length;
+};
+
+static_assert(sizeof(Header) == 24);
+static_assert(sizeof(Record) == 56);
+
+const char magic[4] = {'S', 'N', 'P', 'C'};
+const quint32 version = 3;
+
+// Maps the cache and validates its layout, returns null if missing or invalid
+const uchar *map(QFile &file, Header &header)
+{
+    if (!file.open(QIODevice::ReadOnly))
+        return nullptr;
+
+    const auto size = file.size();
+    if (size < qint64(sizeof(Header)))
+    {
+        WARN << "Discarding truncated index cache" << file.fileName();
+        return nullptr;
+    }
+
+    const uchar *data = file.map(0, size);
+    if (!data)
+    {
+        WARN << "Failed to map index cache" << file.fileName() << file.errorString();
+        return nullptr;
+    }
+
+    memcpy(&header, data, sizeof(Header));
+    if (memcmp(header.magic, magic, sizeof(magic)) != 0
+        || header.version != version
+        || size != qint64(sizeof(Header))
+                       + qint64(header.count) * qint64(sizeof(Record))
+                       + qint64(header.blob_size) * qint64(sizeof(char16_t))
+                       + qint64(header.bytes_size))
+    {
+        WARN << "Discarding invalid index cache" << file.fileName();
+        return nullptr;
+    }
+
+    return data;
+}
+
+}
+
+vector<CachedSnippet> readIndexCache(const QString &path)
+{
+    QFile file(path);
+    Header header;
+    const uchar *data = map(file, header);
+    if (!data)
+        return {};
+
+    const auto *records = reinterpret_cast<const Record *>(data + sizeof(Header));
+    const auto *blob = reinterpret_cast<const QChar *>(records + header.count);
+
+    vector<CachedSnippet> snippets;
+    snippets.reserve(header.count);
+    for (quint32 i = 0; i < header.count; ++i)
+    {
+        const auto &r = records[i];
+        if (quint64(r.name_offset) + r.name_length > header.blob_size
+            || quint64(r.preview_offset) + r.preview_length > header.blob_size)
+        {
+            WARN << "Discarding corrupt index cache" << path;
+            return {};
+        }
+
+        snippets.push_back({QString(blob + r.name_offset, r.name_length),
+                            FileStamp{r.size, r.mtime, r.inode},
+                            QString(blob + r.preview_offset, r.preview_length)});
+    }
+
+    return snippets;
+}
+
+bool readIndexCacheData(const QString &path, vector<CachedSnippet> &snippets)
+{
+    QFile file(path);
+    Header header;
+    const uchar *data = map(file, header);
+    if (!data || header.count != snippets.size())
+        return false;
+
+    const auto *records = reinterpret_cast<const Record *>(data + sizeof(Header));
+    const auto *blob = reinterpret_cast<const QChar *>(records + header.count);
+    const auto *bytes = reinterpret_cast<const char *>(blob + header.blob_size);
+
+    for (quint32 i = 0; i < header.count; ++i)
+    {
+        const auto &r = records[i];
+        if (quint64(r.terms_offset) + r.terms_length > header.bytes_size
+            || quint64(r.text_offset) + r.text_length > header.bytes_size)
+        {
+            WARN << "Discarding corrupt index cache" << path;
+            return false;
+        }
+
+        snippets[i].terms = QByteArray(bytes + r.terms_offset, r.terms_length);
+        snippets[i].text = QByteArray(bytes + r.text_offset, r.text_length);
+    }
+
+    return true;
+}
+
+bool writeIndexCache(const QString &path, const vector<CachedSnippet> &snippets)
+{
+    vector<Record> records;
+    records.reserve(snippets.size());
+    QString blob;
+    QByteArray bytes;
+
+    for (const auto &s : snippets)
+    {
+        records.push_back({
+            .size = s.stamp.size,
+            .mtime = s.stamp.mtime,
+            .inode = s.stamp.inode,
+            .name_offset = quint32(blob.size()),
+            .name_length = quint32(s.file_name.size()),
+            .preview_offset = quint32(blob.size() + s.file_name.size()),
+            .preview_length = quint32(s.preview.size()),
+            .terms_offset = quint32(bytes.size()),
+            .terms_length = quint32(s.terms.size()),
+            .text_offset = quint32(bytes.size() + s.terms.size()),
+            .text_length = quint32(s.text.size())
+        });
+        blob.append(s.file_name);
+        blob.append(s.preview);
+        bytes.append(s.terms);
+        bytes.append(s.text);
+    }
+
+    const Header header{
+        {magic[0], magic[1], magic[2], magic[3]},
+        version,
+        quint32(records.size()),
+        quint32(blob.size()),
+        quint32(bytes.size()),
+        0
+    };
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        WARN << "Failed to write index cache" << path << file.errorString();
+        return false;
+    }
+
+    file.write(reinterpret_cast<const char *>(&header), sizeof(Header));
+    file.write(reinterpret_cast<const char *>(records.data()),
+               qint64(records.size() * sizeof(Record)));
+    file.write(reinterpret_cast<const char *>(blob.utf16()),
+               qint64(blob.size() * sizeof(char16_t)));
+    file.write(bytes);
+
+    if (!file.commit())
+    {
+        WARN << "Failed to commit index cache" << path << file.errorString();
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,43 @@
+// Copyright (c) 2025 Manuel Schneider
+
+#pragma once
+#include "filestamp.h"
+#include <QByteArray>
+#include <QString>
+#include <vector>
+
+struct CachedSnippet
+{
+    QString file_name;
+    FileStamp stamp;
+    QString preview;
+    QByteArray terms;
+    QByteArray text;
+};
+
+///
+/// Reads the names, stamps and previews of the index cache at `path`.
+///
+/// The file is mapped into memory and the strings are copied out without
+/// decoding. The terms and texts are left empty, see readIndexCacheData().
+/// Returns an empty list if the cache is missing or invalid.
+///
+std::vector<CachedSnippet> readIndexCache(const QString &path);
+
+///
+/// Reads the terms and texts of the `snippets` returned by readIndexCache().
+///
+/// They are stored behind the strings, so the snippets can be served before
+/// they are read. Returns false if the cache is invalid or has been
+/// rewritten meanwhile.
+///
+bool readIndexCacheData(const QString &path, std::vector<CachedSnippet> &snippets);
+
+///
+/// Atomically writes the index cache to `path`.
+///
+/// Layout: a header, one fixed size record per snippet, a blob of UTF-16
+/// strings and a blob of UTF-8 terms and texts the records point into.
+/// Native byte order, the cache is local.
+///
+bool writeIndexCache(const QString &path, const std::vector<CachedSnippet> &snippets);
@@ -0,0 +1,83 @@
+// Copyright (c) 2025 Manuel Schneider
+
+#include "indexstats.h"
+#include <bit>
+using namespace Qt::StringLiterals;
+using namespace std;
+
+static const char *phase_names[IndexStats::PhaseCount] = {
+    "enumerate", "stat", "open", "preview", "decode",
+    "tokenize", "merge", "search index", "publish"
+};
+
+IndexStats::Timer::Timer(IndexStats *stats, Phase phase) : stats_(stats), phase_(phase)
+{
+    if (stats_)
+        timer_.start();
+}
+
+IndexStats::Timer::~Timer()
+{
+    if (stats_)
+        stats_->record(phase_, timer_.nsecsElapsed());
+}
+
+void IndexStats::record(Phase phase, qint64 ns)
+{
+    const auto v = quint64(max<qint64>(ns, 1));
+    auto &h = histograms_[phase];
+
+    h.count.fetch_add(1, memory_order_relaxed);
+    h.sum.fetch_add(v, memory_order_relaxed);
+    h.buckets[bit_width(v) - 1].fetch_add(1, memory_order_relaxed);
+
+    for (auto m = h.min.load(memory_order_relaxed);
+         v < m && !h.min.compare_exchange_weak(m, v, memory_order_relaxed);) {}
+    for (auto m = h.max.load(memory_order_relaxed);
+         v > m && !h.max.compare_exchange_weak(m, v, memory_order_relaxed);) {}
+}
+
+QString IndexStats::summary() const
+{
+    auto us = [](quint64 ns){ return QString::number(double(ns) / 1000., 'f', 1); };
+
+    QStringList lines;
+    for (int p = 0; p < PhaseCount; ++p)
+    {
+        const auto &h = histograms_[p];
+        const auto count = h.count.load(memory_order_relaxed);
+        if (count == 0)
+            continue;
+
+        // Upper bound of the bucket containing the 99th percentile
+        quint64 p99 = 0;
+        for (quint64 b = 0, cumulated = 0; b < h.buckets.size(); ++b)
+            if (cumulated += h.buckets[b].load(memory_order_relaxed); cumulated * 100 >= count * 99)
+            {
+                p99 = b < 63 ? (quint64(2) << b) - 1 : ~quint64(0);
+                break;
+            }
+
+        lines << u"%1: n=%2 min=%3µs avg=%4µs p99<=%5µs max=%6µs"_s
+                     .arg(QString::fromLatin1(phase_names[p]))
+                     .arg(count)
+                     .arg(us(h.min.load(memory_order_relaxed)),
+                          us(h.sum.load(memory_order_relaxed) / count),
+                          us(p99),
+                          us(h.max.load(memory_order_relaxed)));
+    }
+    return lines.join(u'\n');
+}
+
+void IndexStats::reset()
+{
+    for (auto &h : histograms_)
+    {
+        h.count = 0;
+        h.sum = 0;
+        h.min = ~quint64(0);
+        h.max = 0;
+        for (auto &b : h.buckets)
+            b = 0;
+    }
+}
@@ -0,0 +1,66 @@
+// Copyright (c) 2025 Manuel Schneider
+
+#pragma once
+#include <QElapsedTimer>
+#include <QString>
+#include <array>
+#include <atomic>
+
+///
+/// Per phase timing histograms of the indexer.
+///
+/// Durations are measured with a monotonic clock and counted in power of two
+/// nanosecond buckets. Recording is lock-free and may happen concurrently.
+///
+class IndexStats
+{
+public:
+
+    enum Phase
+    {
+        Enumerate,  // Directory listing
+        Stat,  // File stamps
+        Open,  // Opening and reading of the indexed prefix
+        Preview,  // Lazy decoding and simplification of a preview prefix
+        Decode,  // Decoding of the full text prefix
+        Tokenize,  // Terms and trigram text
+        Merge,  // Merging the chunk results
+        SearchIndex,  // Building the content and trigram indexes
+        Publish,  // setIndexItems
+        PhaseCount
+    };
+
+    /// Records the lifetime of the object, no-op if `stats` is null.
+    class Timer
+    {
+    public:
+        Timer(IndexStats *stats, Phase phase);
+        ~Timer();
+    private:
+        IndexStats *stats_;
+        Phase phase_;
+        QElapsedTimer timer_;
+    };
+
+    void record(Phase phase, qint64 ns);
+
+    /// Returns a multi-line count/min/avg/p99/max summary of all phases.
+    QString summary() const;
+
+    /// Clears all histograms. Records made concurrently may be partially kept.
+    void reset();
+
+private:
+
+    struct Histogram
+    {
+        std::atomic<quint64> count{0};
+        std::atomic<quint64> sum{0};
+        std::atomic<quint64> min{~quint64(0)};
+        std::atomic<quint64> max{0};
+        std::array<std::atomic<quint64>, 64> buckets{};  // floor(log2(ns))
+    };
+
+    std::array<Histogram, PhaseCount> histograms_;
+
+};
@@ -1,10 +1,34 @@
 // Copyright (c) 2023-2025 Manuel Schneider
 
+#include "contentindex.h"
 #include "filenamedialog.h"
+#include "indexcache.h"
 #include "plugin.h"
+#include "preview.h"
+#include "snippetdatabase.h"
+#include "snippetpack.h"
+#include "snippetreader.h"
+#include "snippetscanner.h"
+#include "snippetstore.h"
+#include "snippettemplate.h"
+#include "snippetwatcher.h"
+#include "trigramindex.h"
+#include "usagelog.h"
 #include "ui_configwidget.h"
+#include <QBuffer>
+#include <QClipboard>
 #include <QFile>
 #include <QFileSystemModel>
+#include <QFutureWatcher>
+#include <QGuiApplication>
+#include <QPointer>
+#include <QProgressDialog>
+#include <QPromise>
+#include <QScopeGuard>
+#include <QSettings>
+#include <QtConcurrentMap>
+#include <QtConcurrentRun>
+#include <unordered_map>
 #include <QTextStream>
 #include <QTimer>
 #include <albert/app.h>
@@ -20,39 +44,158 @@ using namespace std;
 
 static const auto preview_max_size = 100;
 static const auto prefix_add = u"+"_s;
-static unique_ptr<Icon> makeIcon() { return Icon::image(u":snippet"_s); }
+static const auto ck_rescan_quiet_period = "rescan_quiet_period";
+static const auto ck_rescan_max_latency = "rescan_max_latency";
+static const auto ck_indexer_threads = "indexer_threads";
+static const auto ck_fulltext_max_bytes = "fulltext_max_bytes";
+static const auto ck_substring_max_bytes = "substring_max_bytes";
+static const auto ck_trigram_memory_budget = "trigram_memory_budget";
+static const auto ck_body_cache_budget = "body_cache_budget";
+static const auto ck_usage_half_life = "usage_half_life";
+static const auto ck_usage_weight = "usage_weight";
+static const auto ck_expand_placeholders = "expand_placeholders";
+static const auto ck_database = "database";
+static const auto ck_publish_batch_size = "publish_batch_size";
+static const auto usage_saturation = 3.;  // Decayed uses yielding half the boost
+static const auto content_score_factor = 0.5;  // Rank content matches below name matches
+static const auto substring_score = 0.25;
+static const auto progress_threshold = 4 * 1024 * 1024;  // Bytes
+static const auto progress_steps = 1000;
+static const auto database_result_limit = 100;
+
+// Expands the placeholders at paste time, if enabled
+static QString expand(const SnippetTemplate &t, bool placeholders)
+{
+    if (!placeholders)
+        return t.text();
+    return t.expand({.clipboard = []{ return QGuiApplication::clipboard()->text(); }});
+}
+
+// All items share one preloaded icon, handing out cheap clones
+static unique_ptr<Icon> makeIcon()
+{
+    static const unique_ptr<Icon> icon = Icon::image(u":snippet"_s);
+    return icon->clone();
+}
+
+static QString subtext(const QString &preview)
+{
+    static const auto tr = Plugin::tr("Text snippet");
+    return u"%1 – %2"_s.arg(tr, preview);
+}
+
+// Shows the progress of a long read in a dialog that allows to cancel it
+static void showProgress(QFuture<void> future, const QString &name)
+{
+    auto *dialog = new QProgressDialog(Plugin::tr("Reading snippet '%1'…").arg(name),
+                                       Plugin::tr("Cancel"), 0, progress_steps);
+    dialog->setMinimumDuration(500);
+
+    auto *watcher = new QFutureWatcher<void>(dialog);
+    QObject::connect(watcher, &QFutureWatcherBase::progressValueChanged,
+                     dialog, &QProgressDialog::setValue);
+    QObject::connect(watcher, &QFutureWatcherBase::finished,
+                     dialog, &QObject::deleteLater);
+    QObject::connect(dialog, &QProgressDialog::canceled,
+                     watcher, &QFutureWatcherBase::cancel);
+    watcher->setFuture(future);
+}
+
+// Relative path without the .txt suffix. Pack entries are keyed by
+// "<pack relative path>/<entry name>" and that is their id too, even if the
+// entry name ends with .txt.
+static QString snippetId(const QString &key)
+{
+    if (key.endsWith(u".txt"_s) && !key.contains(SnippetPack::suffix + u'/'))
+        return key.chopped(4);
+    return key;
+}
+
+// Splits the id of a pack entry into pack and entry name, the entry name of
+// plain snippets is empty
+static pair<QString, QString> splitId(const QString &id)
+{
+    const auto pack_end = id.lastIndexOf(SnippetPack::suffix + u'/');
+    if (pack_end < 0)
+        return {id + u".txt"_s, {}};
+    const auto name_begin = pack_end + SnippetPack::suffix.size() + 1;
+    return {id.first(name_begin - 1), id.sliced(name_begin)};
+}
+
+// The matches of the last query in the current search indexes, document ids of
+// the content and trigram index respectively. Nothing if the query was too
+// short to be looked up.
+struct QueryCache
+{
+    QString query;
+    optional<ContentIndex::Matches> content_matches{};
+    optional<vector<quint32>> substring_matches{};
+};
+
+struct SnippetItem;
+
+// Items are lightweight views into a columnar store. They live in one vector
+// next to the store and share its allocation and control block, see
+// Plugin::item().
+struct SnippetItems
+{
+    SnippetItems(Plugin *p, const vector<SnippetStore::Snippet> &snippets);
+
+    Plugin * const plugin;
+    const SnippetStore store;
+    vector<SnippetItem> items;
+};
 
 struct SnippetItem : Item
 {
-    SnippetItem(const QFileInfo& fi, Plugin *p)
-        : file_base_name_(fi.completeBaseName()), plugin_(p)
-    {
-        QFile file(fi.filePath());
-        if (file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-            QTextStream in(&file);
-            preview_ = in.readAll().simplified();
-            if (preview_.size() > preview_max_size)
-                preview_ = preview_.left(preview_max_size) + u" …"_s;
-            preview_.squeeze();
-            file.close();
-        } else
-            WARN << "Failed to read from snippet file" << path();
-    }
+    SnippetItem(const SnippetItems *items, quint32 index) : items_(items), index_(index) {}
+
+    QString id() const override { return items_->store.id(index_); }
 
-    QString id() const override { return file_base_name_; }
+    QString text() const override { return items_->store.name(index_); }
 
-    QString text() const override { return file_base_name_; }
+    QString subtext() const override { return ::subtext(preview()); }
+
+    unique_ptr<Icon> icon() const override { return ::makeIcon(); }
 
-    QString subtext() const override
+    // Read on first display
+    QString preview() const
     {
-        static const auto tr = Plugin::tr("Text snippet");
-        return u"%1 – %2"_s.arg(tr, preview_);
+        return items_->store.preview(index_, [this]
+        {
+            IndexStats::Timer t(&plugin()->index_stats, IndexStats::Preview);
+            if (const auto entry = packEntry(); !entry.isEmpty())
+            {
+                const SnippetPack pack(path());
+                if (const auto i = pack.find(entry); i >= 0)
+                {
+                    const auto body = pack.body(i);
+                    auto bytes = QByteArray::fromRawData(body.data(), body.size());
+                    QBuffer buffer(&bytes);
+                    buffer.open(QIODevice::ReadOnly);
+                    return readPreview(buffer, preview_max_size);
+                }
+                WARN << "Failed to read preview of snippet" << entry << "in pack" << path()
+                     << pack.error();
+                return QString();
+            }
+
+            QFile file(path());
+            if (file.open(QIODevice::ReadOnly))
+                return readPreview(file, preview_max_size);
+            WARN << "Failed to read preview of snippet file" << path() << file.errorString();
+            return QString();
+        });
     }
 
-    unique_ptr<Icon> icon() const override { return ::makeIcon(); }
+    Plugin *plugin() const { return items_->plugin; }
 
+    // The snippet file or the pack containing the snippet
     QString path() const
-    { return QDir(plugin_->configLocation()).filePath(file_base_name_ + u".txt"_s); }
+    { return QDir(plugin()->configLocation()).filePath(splitId(id()).first); }
+
+    // The entry name in the pack, empty if not packed
+    QString packEntry() const { return splitId(id()).second; }
 
     static void onReadFailed(const QString &path, const QString &error)
     {
@@ -61,45 +204,187 @@ struct SnippetItem : Item
         warning(Plugin::tr(msg).arg(path, error));
     }
 
-    void copyToClipboard() const
+    struct Body
     {
-        QFile f(path());
-        if (f.open(QIODevice::ReadOnly))
-            setClipboardText(QTextStream(&f).readAll());
+        shared_ptr<const SnippetTemplate> tmpl;
+        QString error;
+    };
+
+    static Body compile(const QString &path, const QString &pack_entry,
+                        const ReadProgress &progress)
+    {
+        SnippetText s;
+        if (pack_entry.isEmpty())
+            s = readSnippet(path, progress);
+        else if (const SnippetPack pack(path); !pack.error().isEmpty())
+            s.error = pack.error();
+        else if (const auto i = pack.find(pack_entry); i < 0)
+            s.error = u"No entry '%1' in snippet pack"_s.arg(pack_entry);
         else
-            onReadFailed(path(), f.errorString());
+            s = decodeSnippet(pack.body(i), path + u'/' + pack_entry, progress);
+
+        if (!s.error.isEmpty())
+            return {nullptr, s.error};
+        return {make_shared<const SnippetTemplate>(s.text), {}};
     }
 
-    void copyToClipboardAndPaste() const
+    // Reads and compiles the snippet in the background, then passes the
+    // expanded text to `done` in the main thread. Cached snippets are passed
+    // right away.
+    void read(function<void(const QString &)> done) const
     {
-        QFile f(path());
-        if (f.open(QIODevice::ReadOnly))
-            setClipboardTextAndPaste(QTextStream(&f).readAll());
-        else
-            onReadFailed(path(), f.errorString());
+        const auto p = path();
+        const auto entry = packEntry();
+        const auto stamp = FileStamp::of(p);
+        if (!stamp)
+            return onReadFailed(p, qt_error_string());
+        const auto key = entry.isEmpty() ? p : p + u'/' + entry;
+
+        auto &cache = plugin()->body_cache;
+        auto handle = [done, placeholders = plugin()->expand_placeholders](const SnippetTemplate &t)
+        { done(expand(t, placeholders)); };
+
+        if (const auto tmpl = cache.get(key, *stamp))
+        {
+            DEBG << u"Body cache hit (%1 hits, %2 misses, %3 KiB)."_s
+                        .arg(cache.hits()).arg(cache.misses()).arg(cache.bytes() / 1024);
+            return handle(*tmpl);
+        }
+
+        auto put = [key, s = *stamp, handle, &cache](const Body &b)
+        {
+            if (b.tmpl)
+            {
+                cache.put(key, s, b.tmpl);
+                handle(*b.tmpl);
+            }
+            else
+                onReadFailed(key, b.error);
+        };
+
+        auto future = QtConcurrent::run([p, entry](QPromise<Body> &promise)
+        {
+            promise.setProgressRange(0, progress_steps);
+            promise.addResult(compile(p, entry, [&](qint64 bytes, qint64 total)
+            {
+                promise.setProgressValue(int(progress_steps * bytes / total));
+                return !promise.isCanceled();
+            }));
+        });
+
+        // The size of a pack bounds the size of its entries
+        if (stamp->size >= progress_threshold)
+            showProgress(future, text());
+
+        // Not called if canceled
+        future.then(plugin(), put);
     }
 
+    void recordUse() const { plugin()->usage_log->record(id()); }
+
+    void copyToClipboard() const
+    { read([](const QString &text){ setClipboardText(text); }); }
+
+    void copyToClipboardAndPaste() const
+    { read([](const QString &text){ setClipboardTextAndPaste(text); }); }
+
     vector<Action> actions() const override
     {
         vector<Action> actions;
 
         if (havePasteSupport())
             actions.emplace_back(u"cp"_s, Plugin::tr("Copy and paste"),
-                                 [this]{ copyToClipboardAndPaste(); });
+                                 [this]{ recordUse(); copyToClipboardAndPaste(); });
 
-        actions.emplace_back(u"c"_s, Plugin::tr("Copy"), [this]{ copyToClipboard(); });
+        actions.emplace_back(u"c"_s, Plugin::tr("Copy"),
+                             [this]{ recordUse(); copyToClipboard(); });
 
-        actions.emplace_back(u"o"_s, Plugin::tr("Edit"), [this]{ open(path()); });
+        // Packs are read-only
+        if (packEntry().isEmpty())
+        {
+            actions.emplace_back(u"o"_s, Plugin::tr("Edit"), [this]{ open(path()); });
 
-        actions.emplace_back(u"r"_s, Plugin::tr("Remove"),
-                             [this]{ plugin_->removeSnippet(file_base_name_ + u".txt"_s); });
+            actions.emplace_back(u"r"_s, Plugin::tr("Remove"),
+                                 [this]{ plugin()->removeSnippet(id() + u".txt"_s); });
+        }
 
         return actions;
     }
 
 private:
 
-    const QString file_base_name_;
+    const SnippetItems * const items_;
+    const quint32 index_;
+};
+
+SnippetItems::SnippetItems(Plugin *p, const vector<SnippetStore::Snippet> &snippets)
+    : plugin(p), store(snippets)
+{
+    items.reserve(store.size());
+    for (qsizetype i = 0; i < store.size(); ++i)
+        items.emplace_back(this, quint32(i));
+}
+
+// A snippet in the database, created per query
+struct DatabaseItem : Item
+{
+    DatabaseItem(const SnippetDatabase::Match &m, Plugin *p)
+        : name_(m.name), preview_(m.preview.simplified()), plugin_(p)
+    {
+        if (preview_.size() > preview_max_size)
+            preview_ = preview_.first(preview_max_size) + u" …"_s;
+    }
+
+    QString id() const override { return u"db:"_s + name_; }
+
+    QString text() const override { return name_.sliced(name_.lastIndexOf(u'/') + 1); }
+
+    QString subtext() const override { return ::subtext(preview_); }
+
+    unique_ptr<Icon> icon() const override { return ::makeIcon(); }
+
+    // Reads the snippet in the background, see SnippetItem::read()
+    void read(function<void(const QString &)> done) const
+    {
+        // The task shares the database, the plugin may be unloaded meanwhile
+        QtConcurrent::run([db = plugin_->database, name = name_]{ return db->body(name); })
+            .then(plugin_, [done, name = name_, placeholders = plugin_->expand_placeholders]
+                           (const optional<QString> &body)
+        {
+            if (body)
+                done(expand(SnippetTemplate(*body), placeholders));
+            else
+                SnippetItem::onReadFailed(name, Plugin::tr("Not found in the database."));
+        });
+    }
+
+    vector<Action> actions() const override
+    {
+        vector<Action> actions;
+
+        if (havePasteSupport())
+            actions.emplace_back(u"cp"_s, Plugin::tr("Copy and paste"), [this]{
+                plugin_->usage_log->record(id());
+                read([](const QString &text){ setClipboardTextAndPaste(text); });
+            });
+
+        actions.emplace_back(u"c"_s, Plugin::tr("Copy"), [this]{
+            plugin_->usage_log->record(id());
+            read([](const QString &text){ setClipboardText(text); });
+        });
+
+        actions.emplace_back(u"r"_s, Plugin::tr("Remove"), [this]{
+            if (question(Plugin::tr("Delete snippet '%1' from the database?").arg(name_))
+                && plugin_->database->remove(name_))
+                plugin_->rescan();  // An imported snippet file shows up again
+        });
+
+        return actions;
+    }
+
+private:
+
+    const QString name_;
     QString preview_;
     Plugin * const plugin_;
 };
@@ -107,34 +392,79 @@ private:
 
 Plugin::Plugin()
 {
+    ::makeIcon();  // Load the shared icon on the main thread, not in the first query
+
     const auto conf_path = configLocation();
 
     filesystem::create_directories(conf_path);
 
-    fs_watcher.addPath(QString::fromLocal8Bit(conf_path.c_str()));
-    connect(&fs_watcher, &QFileSystemWatcher::directoryChanged,
-            this, [this]{ updateIndexItems(); });
+    auto s = settings();
+    rescan_quiet_period = s->value(ck_rescan_quiet_period, 100).toInt();
+    rescan_max_latency = s->value(ck_rescan_max_latency, 1000).toInt();
+
+    rescan_timer.setSingleShot(true);
+    connect(&rescan_timer, &QTimer::timeout, this, &Plugin::rescan);
+
+    fs_watcher = new SnippetWatcher(QString::fromLocal8Bit(conf_path.c_str()), this);
+    connect(fs_watcher, &SnippetWatcher::directoryChanged,
+            this, &Plugin::onDirectoryChanged);
+    connect(fs_watcher, &SnippetWatcher::filesChanged,
+            this, &Plugin::onFilesChanged);
+    connect(fs_watcher, &SnippetWatcher::subtreeChanged,
+            this, &Plugin::onSubtreeChanged);
+
+    index_pool.setMaxThreadCount(
+        s->value(ck_indexer_threads, QThread::idealThreadCount()).toInt());
+    index_limits = {
+        .fulltext_bytes = s->value(ck_fulltext_max_bytes, 256 * 1024).toLongLong(),
+        .substring_bytes = s->value(ck_substring_max_bytes, 16 * 1024).toLongLong()
+    };
+    trigram_memory_budget = s->value(ck_trigram_memory_budget, 64 * 1024 * 1024).toLongLong();
+    body_cache.setBudget(s->value(ck_body_cache_budget, 16 * 1024 * 1024).toLongLong());
+
+    filesystem::create_directories(dataLocation());
+    usage_log = make_unique<UsageLog>(QDir(dataLocation()).filePath(u"usage"_s),
+                                      s->value(ck_usage_half_life, 7.).toDouble());
+    usage_weight = s->value(ck_usage_weight, .2).toDouble();
+    expand_placeholders = s->value(ck_expand_placeholders, false).toBool();
+    publish_batch_size = max(1, s->value(ck_publish_batch_size, 1000).toInt());
 
-    indexer.parallel = [this](const bool &abort)
+    if (s->value(ck_database, false).toBool())
     {
-        vector<IndexItem> r;
-        for (const auto files = QDir(configLocation()).entryInfoList({u"*.txt"_s}, QDir::Files);
-             const auto &f : files)
+        database = make_shared<SnippetDatabase>(QDir(dataLocation()).filePath(u"snippets.sqlite"_s));
+        if (database->error().isEmpty())
+            INFO << u"Snippet database holds %1 snippets."_s.arg(database->size());
+        else
         {
-            if (abort) return r;
-            r.emplace_back(make_shared<SnippetItem>(f, this), f.completeBaseName());
+            WARN << "Failed to open the snippet database:" << database->error();
+            database.reset();
         }
-        return r;
-    };
+    }
+
+    filesystem::create_directories(cacheLocation());
+
+    indexer.parallel = [this](const bool &abort) { return scan(abort); };
 
     indexer.finish = [this]
     {
         auto index_items = indexer.takeResult();
         INFO << u"Indexed %1 snippets."_s.arg(index_items.size());
-        setIndexItems(::move(index_items));
+        {
+            IndexStats::Timer t(&index_stats, IndexStats::Publish);
+            setIndexItems(::move(index_items));
+        }
+        DEBG << "Indexer timings:\n" << qPrintable(index_stats.summary());
+
+        if (rescan_queued)
+        {
+            rescan_queued = false;
+            indexer.run();
+        }
     };
 }
 
+Plugin::~Plugin() = default;
+
 QString Plugin::defaultTrigger() const { return u"snip "_s; }
 
 QString Plugin::synopsis(const QString &q) const
@@ -148,12 +478,457 @@ QString Plugin::synopsis(const QString &q) const
         return tr_s;
 }
 
-void Plugin::updateIndexItems() { indexer.run(); }
+void Plugin::updateIndexItems()
+{
+    {
+        lock_guard lock(scan_request_mutex);
+        scan_request.full = true;
+    }
+    indexer.run();
+}
+
+QString Plugin::indexCachePath() const
+{ return QDir(cacheLocation()).filePath(u"index"_s); }
+
+void Plugin::onDirectoryChanged()
+{
+    ++fs_events;
+
+    if (rescan_latency.isValid())
+        ++fs_events_merged;
+    else
+        rescan_latency.start();
+
+    // Restart the quiet period, but do not exceed the max latency of the burst
+    const auto remaining = rescan_max_latency - rescan_latency.elapsed();
+    rescan_timer.start(static_cast<int>(clamp<qint64>(remaining, 0, rescan_quiet_period)));
+}
+
+void Plugin::onFilesChanged(const QStringList &changed, const QStringList &removed)
+{
+    // Read by the indexer, off the main thread
+    {
+        lock_guard lock(scan_request_mutex);
+        scan_request.files << changed << removed;
+    }
+
+    if (indexer.isRunning())
+        rescan_queued = true;
+    else
+        indexer.run();
+}
+
+void Plugin::onSubtreeChanged(const QString &relative_dir)
+{
+    {
+        lock_guard lock(scan_request_mutex);
+        scan_request.subtrees << relative_dir;
+    }
+
+    if (indexer.isRunning())
+        rescan_queued = true;
+    else
+        indexer.run();
+}
+
+vector<IndexItem> Plugin::scan(const bool &abort)
+{
+    ScanRequest request;
+    {
+        lock_guard lock(scan_request_mutex);
+        request = ::exchange(scan_request, {.full = false});
+    }
+
+    // Hand the request back if the scan gets aborted
+    auto restore_request = qScopeGuard([&]{
+        lock_guard lock(scan_request_mutex);
+        scan_request.full |= request.full;
+        scan_request.subtrees << request.subtrees;
+        scan_request.files << request.files;
+    });
+
+    // Serve the cached index until this scan validated it
+    if (!cache_loaded)
+    {
+        cache_loaded = true;
+        loadIndexCache();
+    }
+
+    const ScanContext context{
+        QString::fromLocal8Bit(configLocation().c_str()), index_limits, &index_pool, &index_stats
+    };
+
+    // All files or the files of the subtrees and the files reported by the
+    // watcher that still exist. Paths are relative to the config location.
+    QStringList file_names;
+    if (request.full)
+        file_names = listSnippetFiles(context, {QString()}, abort);
+    else
+    {
+        if (!request.subtrees.isEmpty())
+            file_names = listSnippetFiles(context, request.subtrees, abort);
+        request.files.removeDuplicates();
+        for (const auto &file_name : request.files)
+            if (QFileInfo::exists(context.dir + u'/' + file_name))
+                file_names << file_name;
+        file_names.removeDuplicates();
+    }
+    if (abort) return {};
+
+    // The database serves the imported snippet files
+    if (database)
+        if (const auto imported = database->names(); !imported.isEmpty())
+            file_names.removeIf([&](const QString &f)
+                                { return !isPack(f) && imported.contains(snippetId(f)); });
+
+    // A partial request replaces the entries of the subtrees and files only
+    IndexTable table;
+    size_t replaced = index_table.size();
+    if (!request.full)
+    {
+        table = index_table;
+        replaced = 0;
+        for (const auto &subtree : request.subtrees)
+        {
+            const auto [begin, end] = entriesBelow(table, subtree);
+            replaced += distance(begin, end);
+            table.erase(begin, end);
+        }
+        for (const auto &file_name : request.files)
+        {
+            replaced += eraseSnippetFile(table, file_name);
+            body_cache.remove(context.dir + u'/' + file_name);  // Removed or re-read
+        }
+    }
+
+    // Reuse the entries of unchanged files, only read added or modified ones.
+    // Without a previous index the user would see nothing until the scan
+    // finished, publish partial results then.
+    auto result = request.full && index_table.empty()
+                      ? scanProgressively(context, file_names, abort)
+                      : scanSnippetFiles(context, file_names, index_table, ::move(table), abort);
+    if (!result)
+        return {};
+    table = ::move(result->table);
+
+    for (const auto &[file_name, entry] : table)
+        if (entry.slot < 0)
+            body_cache.remove(context.dir + u'/' + file_name);  // Stale
+
+    DEBG << u"Scanned %1 snippets in %2 chunks, reused %3, %4 indexed."_s
+                .arg(result->scanned).arg(result->chunks).arg(result->reused).arg(table.size());
+
+    // Last exit, from here on the table and the search indexes are updated together
+    if (abort) return {};
+
+    restore_request.dismiss();
+
+    // Apply the trigram memory budget in table order. The texts exceeding it
+    // are dropped, neither kept nor cached. They are read again if their file
+    // changes.
+    qsizetype text_usage = 0;
+    uint texts_dropped = 0;
+    for (auto &[file_name, entry] : table)
+    {
+        const auto cost = TrigramIndex::cost(entry.text);
+        if (text_usage + cost <= trigram_memory_budget)
+            text_usage += cost;
+        else
+        {
+            entry.text = {};
+            ++texts_dropped;
+        }
+    }
+    if (texts_dropped)
+        WARN << u"Trigram memory budget exhausted, %1 snippets are not substring searchable."_s
+                    .arg(texts_dropped);
+
+    index_table = ::move(table);
+    updateItems();
+
+    if (cache_dirty || texts_dropped
+        || result->reused != result->scanned || result->scanned != replaced)
+    {
+        vector<CachedSnippet> cache;
+        cache.reserve(index_table.size());
+        for (const auto &[file_name, entry] : index_table)
+            cache.push_back({file_name, entry.stamp,
+                             snippet_items->store.knownPreview(entry.slot),
+                             entry.terms, entry.text});
+        cache_dirty = !writeIndexCache(indexCachePath(), cache);
+    }
+
+    updateContentIndex(index_table, snippet_items);
+    return indexItems(index_table, snippet_items);
+}
+
+optional<ScanResult> Plugin::scanProgressively(const ScanContext &context,
+                                               const QStringList &file_names,
+                                               const bool &abort)
+{
+    // Frequently used and recently modified snippets first
+    const auto stamps = QtConcurrent::blockingMapped<vector<optional<FileStamp>>>(
+        context.pool, file_names, [&](const QString &file_name)
+    {
+        IndexStats::Timer t(context.stats, IndexStats::Stat);
+        return FileStamp::of(context.dir + u'/' + file_name);
+    });
+    if (abort) return {};
+
+    struct Key
+    {
+        double uses;
+        qint64 mtime;
+        qsizetype index;
+    };
+    vector<Key> keys;
+    keys.reserve(file_names.size());
+    for (qsizetype i = 0; i < file_names.size(); ++i)
+        keys.push_back({usage_log->score(snippetId(file_names[i])),
+                        stamps[i] ? stamps[i]->mtime : 0, i});
+    sort(keys.begin(), keys.end(), [](const Key &l, const Key &r) {
+        return tie(r.uses, r.mtime) < tie(l.uses, l.mtime);
+    });
+
+    // Read in batches, publishing the entries read so far after each. The
+    // batches double in size, which bounds the cost of the partial search
+    // indexes to a multiple of the final one.
+    ScanResult result;
+    auto batch_size = qsizetype(publish_batch_size);
+    for (auto begin = keys.begin(); begin != keys.end(); batch_size *= 2)
+    {
+        const auto end = begin + min(batch_size, qsizetype(keys.end() - begin));
+        QStringList batch_names;
+        vector<optional<FileStamp>> batch_stamps;
+        batch_names.reserve(end - begin);
+        batch_stamps.reserve(end - begin);
+        for (auto k = begin; k != end; ++k)
+        {
+            batch_names << file_names[k->index];
+            batch_stamps.push_back(stamps[k->index]);
+        }
+
+        auto batch = scanSnippetFiles(context, batch_names, {}, ::move(result.table), abort,
+                                      batch_stamps);
+        if (!batch)
+            return {};
+        batch->scanned += result.scanned;
+        batch->reused += result.reused;
+        batch->chunks += result.chunks;
+        result = ::move(*batch);
+
+        if ((begin = end) != keys.end())
+            publishPartial(result.table);
+    }
+    return result;
+}
+
+void Plugin::loadIndexCache()
+{
+    const auto path = indexCachePath();
+    auto cached = readIndexCache(path);
+    if (cached.empty())
+        return;
+
+    // Serve the names first, the terms and texts follow
+    vector<SnippetStore::Snippet> snippets;
+    snippets.reserve(cached.size());
+    for (const auto &c : cached)
+    {
+        const qsizetype slot = snippets.size();
+        index_table.emplace(c.file_name, IndexEntry{c.stamp, {}, {}, slot});
+        snippets.push_back({snippetId(c.file_name), c.preview});
+    }
+    snippet_items = make_shared<SnippetItems>(this, snippets);
+
+    INFO << u"Loaded %1 snippets from cache."_s.arg(index_table.size());
+    auto index_items = indexItems(index_table, snippet_items);
+    QMetaObject::invokeMethod(this, [this, index_items = ::move(index_items)]() mutable {
+        setIndexItems(::move(index_items));
+    });
+
+    if (!readIndexCacheData(path, cached))
+    {
+        index_table.clear();  // Read all files again
+        snippet_items.reset();
+        return;
+    }
+
+    for (auto &c : cached)
+    {
+        auto &entry = index_table.at(c.file_name);
+        entry.terms = ::move(c.terms);
+        entry.text = ::move(c.text);
+    }
+    updateContentIndex(index_table, snippet_items);
+}
+
+void Plugin::updateItems()
+{
+    snippet_items = buildItems(index_table);
+    DEBG << u"Snippet store uses %1 KiB."_s.arg(snippet_items->store.memoryUsage() / 1024);
+}
+
+shared_ptr<SnippetItems> Plugin::buildItems(IndexTable &table)
+{
+    // Carry over the previews read so far
+    vector<SnippetStore::Snippet> snippets;
+    snippets.reserve(table.size());
+    for (auto &[file_name, entry] : table)
+    {
+        QString preview;
+        if (entry.slot >= 0)
+            preview = snippet_items->store.knownPreview(entry.slot);
+        entry.slot = snippets.size();
+        snippets.push_back({snippetId(file_name), preview});
+    }
+
+    return make_shared<SnippetItems>(this, snippets);
+}
+
+shared_ptr<Item> Plugin::item(const shared_ptr<SnippetItems> &items, const IndexEntry &entry)
+{ return {items, &items->items[entry.slot]}; }
+
+void Plugin::updateContentIndex(const IndexTable &table, const shared_ptr<SnippetItems> &items)
+{
+    IndexStats::Timer t(&index_stats, IndexStats::SearchIndex);
+    vector<ContentIndex::Document> documents;
+    vector<TrigramIndex::Document> texts;
+    documents.reserve(table.size());
+    texts.reserve(table.size());
+    for (const auto &[file_name, entry] : table)
+    {
+        documents.push_back({item(items, entry), entry.terms});
+        texts.push_back({item(items, entry), entry.text});
+    }
+
+    auto c_index = make_shared<const ContentIndex>(documents);
+    auto t_index = make_shared<const TrigramIndex>(texts, trigram_memory_budget);
+    DEBG << u"Trigram index uses %1 KiB."_s.arg(t_index->memoryUsage() / 1024);
+
+    lock_guard lock(search_index_mutex);
+    content_index = ::move(c_index);
+    trigram_index = ::move(t_index);
+    query_cache.reset();
+}
+
+void Plugin::publishPartial(IndexTable table)
+{
+    auto items = buildItems(table);
+    updateContentIndex(table, items);
+    DEBG << u"Publishing %1 snippets of the running scan."_s.arg(table.size());
+    QMetaObject::invokeMethod(this, [this, index_items = indexItems(table, items)]() mutable {
+        IndexStats::Timer t(&index_stats, IndexStats::Publish);
+        setIndexItems(::move(index_items));
+    });
+}
+
+vector<IndexItem> Plugin::indexItems(const IndexTable &table,
+                                     const shared_ptr<SnippetItems> &items)
+{
+    vector<IndexItem> r;
+    r.reserve(table.size());
+    for (const auto &[file_name, entry] : table)
+    {
+        const auto id = snippetId(file_name);
+        const auto slash = id.lastIndexOf(u'/');
+        r.emplace_back(item(items, entry), id.sliced(slash + 1));
+
+        // Folders and packs are additional keywords
+        if (slash >= 0)
+            r.emplace_back(item(items, entry),
+                           QString(id).replace(SnippetPack::suffix + u'/', u" "_s)
+                                      .replace(u'/', u' '));
+    }
+    return r;
+}
+
+void Plugin::rescan()
+{
+    rescan_latency.invalidate();
+
+    {
+        lock_guard lock(scan_request_mutex);
+        scan_request.full = true;
+    }
+
+    // At most one scan in flight and one queued
+    if (indexer.isRunning())
+    {
+        if (rescan_queued)
+            ++fs_events_merged;
+        rescan_queued = true;
+    }
+    else
+        indexer.run();
+
+    DEBG << u"Coalesced %1 of %2 directory change events."_s
+                .arg(fs_events_merged).arg(fs_events);
+}
 
 vector<RankItem> Plugin::rankItems(QueryContext &ctx)
 {
     vector<RankItem> results = IndexQueryHandler::rankItems(ctx);
 
+    shared_ptr<const ContentIndex> c_index;
+    shared_ptr<const TrigramIndex> t_index;
+    shared_ptr<const QueryCache> previous;
+    {
+        lock_guard lock(search_index_mutex);
+        c_index = content_index;
+        t_index = trigram_index;
+        previous = query_cache;
+    }
+
+    // While typing, each query extends the previous one and can only match a
+    // subset of its documents. Verify these instead of searching the index.
+    auto cache = make_shared<QueryCache>();
+    cache->query = ctx.query();
+    const bool narrow = previous && ctx.query().startsWith(previous->query);
+    if (c_index)
+        cache->content_matches = c_index->match(
+            ctx.query(), narrow && previous->content_matches ? &*previous->content_matches : nullptr);
+    if (t_index)
+        cache->substring_matches = t_index->match(
+            ctx.query(), narrow && previous->substring_matches ? &*previous->substring_matches : nullptr);
+    {
+        lock_guard lock(search_index_mutex);
+        if (c_index == content_index && t_index == trigram_index)  // Not replaced meanwhile
+            query_cache = cache;
+    }
+
+    // Merge content matches, keep the best score per snippet. By id, the items
+    // of a changed file are replaced in the search indexes before they are in
+    // the albert index.
+    unordered_map<QString, size_t> positions;
+    for (size_t i = 0; i < results.size(); ++i)
+        positions.emplace(results[i].item->id(), i);
+
+    auto merge = [&](shared_ptr<Item> item, double score)
+    {
+        if (const auto [it, inserted] = positions.emplace(item->id(), results.size()); inserted)
+            results.emplace_back(::move(item), score);
+        else
+            results[it->second].score = max(results[it->second].score, score);
+    };
+
+    if (cache->content_matches)
+        for (const auto &[id, score] : *cache->content_matches)
+            merge(c_index->item(id), content_score_factor * score);
+
+    if (cache->substring_matches)
+        for (const auto id : *cache->substring_matches)
+            merge(t_index->item(id), substring_score);
+
+    if (database)
+        for (const auto &m : database->search(ctx.query(), database_result_limit))
+            results.emplace_back(make_shared<DatabaseItem>(m, this), m.score);
+
+    // Boost frequently and recently used snippets towards 1
+    for (auto &r : results)
+        if (const auto uses = usage_log->score(r.item->id()); uses > 0.)
+            r.score += (1. - r.score) * usage_weight * uses / (uses + usage_saturation);
+
     if (ctx.query().startsWith(prefix_add))
         results.emplace_back(
             StandardItem::make(
@@ -184,10 +959,17 @@ void Plugin::addSnippet(const QString &text, QWidget *parent) const
     dialog->setAttribute(Qt::WA_DeleteOnClose);
     dialog->open();
 
-    connect(dialog, &QDialog::finished, this, [text, dialog](int result){
+    connect(dialog, &QDialog::finished, this, [this, text, dialog](int result){
         if (result == QDialog::Accepted)
         {
-            if (QFile file(dialog->filePath());
+            // Texts go to the database if enabled, empty snippets need an editor
+            if (database && !text.isEmpty())
+            {
+                if (!database->put(dialog->name(), text))
+                    critical(tr("Failed to store the snippet '%1' in the database.")
+                                 .arg(dialog->name()));
+            }
+            else if (QFile file(dialog->filePath());
                 file.open(QIODevice::WriteOnly))
             {
                 if (text.isEmpty())
@@ -239,7 +1021,8 @@ class RedIfNotTxtFileSystemModel : public QFileSystemModel
 public:
     RedIfNotTxtFileSystemModel(QObject *parent) : QFileSystemModel(parent){}
     virtual QVariant data(const QModelIndex & index, int role = Qt::DisplayRole) const {
-        if (role == Qt::ForegroundRole && !index.data().toString().endsWith(u".txt"_s))
+        if (role == Qt::ForegroundRole
+            && !index.data().toString().endsWith(u".txt"_s) && !isPack(index.data().toString()))
             return QColorConstants::Red;
         else
             return QFileSystemModel::data(index, role);
@@ -270,6 +1053,33 @@ QWidget *Plugin::buildConfigWidget()
     connect(ui.pushButton_add, &QPushButton::clicked,
             this, [this](){ addSnippet({}, config_widget); });
 
+    connect(ui.pushButton_stats, &QPushButton::clicked, this, [this]
+    {
+        INFO << "Indexer timings:\n" << qPrintable(index_stats.summary());
+        index_stats.reset();  // The next click shows the timings since this one
+    });
+
+    ui.pushButton_import->setVisible(bool(database));
+    connect(ui.pushButton_import, &QPushButton::clicked, this,
+            [this, button = QPointer(ui.pushButton_import)]
+    {
+        button->setEnabled(false);
+        QtConcurrent::run([db = database, dir = QString::fromLocal8Bit(configLocation().c_str())]
+                          { return db->import(dir); })
+            .then(this, [this, button](qsizetype count)
+        {
+            if (button)
+                button->setEnabled(true);
+            if (count < 0)
+                warning(tr("Failed to import the snippets into the database."));
+            else
+            {
+                INFO << u"Imported %1 snippets into the database."_s.arg(count);
+                rescan();  // Drops the imported files from the index
+            }
+        });
+    });
+
     connect(ui.pushButton_remove, &QPushButton::clicked, this,
             [this, model, lw=ui.listView](){
         if (lw->currentIndex().isValid())
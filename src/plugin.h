@@ -2,12 +2,28 @@
 
 #pragma once
 
+#include "bodycache.h"
+#include "indexstats.h"
+#include "snippetscanner.h"
 #include "snippets.h"
-#include <QFileSystemWatcher>
+#include <QElapsedTimer>
+#include <QThreadPool>
+#include <QTimer>
 #include <albert/backgroundexecutor.h>
 #include <albert/extensionplugin.h>
 #include <albert/indexqueryhandler.h>
+#include <memory>
+#include <mutex>
+class ContentIndex;
 class QWidget;
+class SnippetDatabase;
+class TrigramIndex;
+class UsageLog;
+class SnippetWatcher;
+struct DatabaseItem;
+struct QueryCache;
+struct SnippetItem;
+struct SnippetItems;
 
 class Plugin : public albert::ExtensionPlugin,
                public albert::IndexQueryHandler,
@@ -15,9 +31,12 @@ class Plugin : public albert::ExtensionPlugin,
 
 {
     ALBERT_PLUGIN
+    friend struct DatabaseItem;
+    friend struct SnippetItem;
 public:
 
     Plugin();
+    ~Plugin() override;
 
     void addSnippet(const QString &text = {}, QWidget *modal_parent = nullptr) const override;
     void removeSnippet(const QString &file_name) const;
@@ -30,8 +49,72 @@ private:
     QString synopsis(const QString &) const override;
     std::vector<albert::RankItem> rankItems(albert::QueryContext &) override;
 
+    void onDirectoryChanged();
+    void onFilesChanged(const QStringList &changed, const QStringList &removed);
+    void onSubtreeChanged(const QString &relative_dir);
+    void rescan();
+    std::vector<albert::IndexItem> scan(const bool &abort);
+    std::optional<ScanResult> scanProgressively(const ScanContext &context,
+                                                const QStringList &file_names,
+                                                const bool &abort);
+    QString indexCachePath() const;
+    void loadIndexCache();  // Into the empty table, in the indexer
+    void updateItems();
+    // Assigns the slots of the entries of `table` in the returned items
+    std::shared_ptr<SnippetItems> buildItems(IndexTable &table);
+    static std::shared_ptr<albert::Item> item(const std::shared_ptr<SnippetItems> &items,
+                                              const IndexEntry &entry);
+    static std::vector<albert::IndexItem> indexItems(const IndexTable &table,
+                                                     const std::shared_ptr<SnippetItems> &items);
+    void updateContentIndex(const IndexTable &table, const std::shared_ptr<SnippetItems> &items);
+    void publishPartial(IndexTable table);
+
+    struct ScanRequest
+    {
+        bool full = true;
+        QStringList subtrees;  // Relative directories, if not full
+        QStringList files;  // Changed or removed relative paths, if not full
+    };
+
     QWidget *config_widget = nullptr;
-    QFileSystemWatcher fs_watcher;
+    SnippetWatcher *fs_watcher;
+
+    // Coalesces bursts of directory change events into a single rescan
+    QTimer rescan_timer;
+    QElapsedTimer rescan_latency;  // Since the first event of the pending burst
+    int rescan_quiet_period;  // ms
+    int rescan_max_latency;  // ms
+    bool rescan_queued = false;
+    uint fs_events = 0;
+    uint fs_events_merged = 0;
+
+    ScanRequest scan_request;
+    std::mutex scan_request_mutex;
+    QThreadPool index_pool;
+    IndexStats index_stats;
+    // Relative path -> entry. Owned by the indexer while it runs, by the main thread otherwise.
+    IndexTable index_table;
+    std::shared_ptr<SnippetItems> snippet_items;  // Built from the table, same ownership
+    bool cache_loaded = false;  // Owned by the indexer
+    bool cache_dirty = false;  // The table differs from the index cache
+    int publish_batch_size;  // Files in the first partial result of an initial scan
+
+    IndexLimits index_limits;
+    qsizetype trigram_memory_budget;
+    std::shared_ptr<const ContentIndex> content_index;
+    std::shared_ptr<const TrigramIndex> trigram_index;
+    std::shared_ptr<const QueryCache> query_cache;  // Reset with the search indexes
+    std::mutex search_index_mutex;
+
+    BodyCache body_cache;
+    bool expand_placeholders;
+
+    std::unique_ptr<UsageLog> usage_log;
+    double usage_weight;
+
+    std::shared_ptr<SnippetDatabase> database;  // Optional, shared with background tasks
+
+    // Declared last, destructed first. Waits for the scan using the members above.
     albert::BackgroundExecutor<std::vector<albert::IndexItem>> indexer;
 
 };
@@ -0,0 +1,47 @@
+// Copyright (c) 2025 Manuel Schneider
+
+#include "preview.h"
+#include <QIODevice>
+#include <QStringDecoder>
+using namespace Qt::StringLiterals;
+
+QString readPreview(QIODevice &device, qsizetype max_size)
+{
+    QStringDecoder decoder(QStringDecoder::Utf8);
+    QString preview;
+    preview.reserve(max_size + 2);
+    bool pending_space = false;
+    bool truncated = false;
+
+    // Appends to the preview unless it is full
+    auto append = [&](QChar c)
+    {
+        if (preview.size() == max_size)
+            truncated = true;
+        else
+            preview.append(c);
+        return !truncated;
+    };
+
+    char buf[4096];
+    for (qint64 len; !truncated && (len = device.read(buf, sizeof(buf))) > 0;)
+    {
+        const QString chunk = decoder.decode(QByteArrayView(buf, len));
+        for (const QChar c : chunk)
+        {
+            if (c.isSpace())
+                pending_space = !preview.isEmpty();
+
+            else if ((!pending_space || append(u' ')) && append(c))
+                pending_space = false;
+
+            else
+                break;
+        }
+    }
+
+    if (truncated)
+        preview.append(u" …"_s);
+
+    return preview;
+}
@@ -0,0 +1,14 @@
+// Copyright (c) 2025 Manuel Schneider
+
+#pragma once
+#include <QString>
+class QIODevice;
+
+///
+/// Reads a whitespace simplified preview of at most `max_size` characters.
+///
+/// Equivalent to `readAll().simplified()` truncated to `max_size` characters
+/// plus an ellipsis, but decodes the device incrementally and stops reading
+/// as soon as the preview is complete.
+///
+QString readPreview(QIODevice &device, qsizetype max_size);
@@ -0,0 +1,253 @@
+// Copyright (c) 2025 Manuel Schneider
+
+#include "snippetdatabase.h"
+#include "snippetreader.h"
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QHash>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QStringList>
+#include <albert/logging.h>
+#include <atomic>
+using namespace Qt::StringLiterals;
+using namespace std;
+
+static const char *schema[] = {
+    "CREATE TABLE IF NOT EXISTS snippets("
+    " id INTEGER PRIMARY KEY,"
+    " name TEXT UNIQUE NOT NULL,"
+    " body TEXT NOT NULL,"
+    " mtime INTEGER NOT NULL)",
+
+    "CREATE VIRTUAL TABLE IF NOT EXISTS snippets_fts USING fts5("
+    " name, body, content='snippets', content_rowid='id', prefix='2 3')",
+
+    "CREATE TRIGGER IF NOT EXISTS snippets_ai AFTER INSERT ON snippets BEGIN"
+    " INSERT INTO snippets_fts(rowid, name, body) VALUES (new.id, new.name, new.body);"
+    " END",
+
+    "CREATE TRIGGER IF NOT EXISTS snippets_ad AFTER DELETE ON snippets BEGIN"
+    " INSERT INTO snippets_fts(snippets_fts, rowid, name, body)"
+    "  VALUES ('delete', old.id, old.name, old.body);"
+    " END",
+
+    "CREATE TRIGGER IF NOT EXISTS snippets_au AFTER UPDATE ON snippets BEGIN"
+    " INSERT INTO snippets_fts(snippets_fts, rowid, name, body)"
+    "  VALUES ('delete', old.id, old.name, old.body);"
+    " INSERT INTO snippets_fts(rowid, name, body) VALUES (new.id, new.name, new.body);"
+    " END"
+};
+
+static const auto upsert =
+    u"INSERT INTO snippets(name, body, mtime) VALUES (?, ?, ?)"
+    " ON CONFLICT(name) DO UPDATE SET body = excluded.body, mtime = excluded.mtime"_s;
+
+// Each word as quoted prefix token, implicitly AND-ed
+static QString matchExpression(const QString &query)
+{
+    QStringList tokens;
+    for (const auto &word : query.split(u' ', Qt::SkipEmptyParts))
+        tokens << u"\"%1\"*"_s.arg(QString(word).replace(u'"', u"\"\""_s));
+    return tokens.join(u' ');
+}
+
+namespace
+{
+
+// The connections of the current thread by database serial. A connection may
+// only be used and removed by the thread that created it.
+struct ThreadConnections
+{
+    ~ThreadConnections()
+    {
+        for (const auto &name : std::as_const(names))
+            QSqlDatabase::removeDatabase(name);
+    }
+
+    QHash<quint64, QString> names;
+};
+
+thread_local ThreadConnections thread_connections;
+
+// Serials are never reused, unlike addresses of objects and threads
+atomic<quint64> next_serial{0};
+atomic<quint64> next_connection{0};
+
+}
+
+SnippetDatabase::SnippetDatabase(const QString &path) : path_(path), serial_(next_serial++)
+{
+    auto db = connection();
+    if (!db.isOpen())
+    {
+        error_ = db.lastError().text();
+        return;
+    }
+
+    QSqlQuery q(db);
+    if (!q.exec(u"PRAGMA journal_mode=WAL"_s) || !q.exec(u"PRAGMA synchronous=NORMAL"_s))
+        WARN << "Failed to enable WAL mode:" << q.lastError().text();
+
+    for (const auto *statement : schema)
+        if (!q.exec(QString::fromUtf8(statement)))
+        {
+            error_ = q.lastError().text();  // E.g. SQLite built without FTS5
+            return;
+        }
+}
+
+SnippetDatabase::~SnippetDatabase()
+{
+    // The connections of other threads are removed when these finish
+    if (const auto name = thread_connections.names.take(serial_); !name.isEmpty())
+        QSqlDatabase::removeDatabase(name);
+}
+
+const QString &SnippetDatabase::error() const { return error_; }
+
+QSqlDatabase SnippetDatabase::connection() const
+{
+    auto &name = thread_connections.names[serial_];
+    if (!name.isEmpty())
+        return QSqlDatabase::database(name);
+
+    name = u"snippets-%1"_s.arg(next_connection++);
+    auto db = QSqlDatabase::addDatabase(u"QSQLITE"_s, name);
+    db.setDatabaseName(path_);
+    db.setConnectOptions(u"QSQLITE_BUSY_TIMEOUT=5000"_s);
+    if (!db.open())
+        WARN << "Failed to open snippet database" << path_ << db.lastError().text();
+    return db;
+}
+
+vector<SnippetDatabase::Match> SnippetDatabase::search(const QString &query, int limit) const
+{
+    const auto expression = matchExpression(query);
+    if (expression.isEmpty())
+        return {};
+
+    QSqlQuery q(connection());
+    q.prepare(u"SELECT s.name, substr(s.body, 1, 400), bm25(snippets_fts, 10.0, 1.0) AS rank"
+              " FROM snippets_fts JOIN snippets s ON s.id = snippets_fts.rowid"
+              " WHERE snippets_fts MATCH ? ORDER BY rank LIMIT ?"_s);
+    q.addBindValue(expression);
+    q.addBindValue(limit);
+    if (!q.exec())
+    {
+        WARN << "Snippet database search failed:" << q.lastError().text();
+        return {};
+    }
+
+    vector<Match> matches;
+    while (q.next())
+    {
+        const auto relevance = -q.value(2).toDouble();  // bm25 is negative, lower is better
+        matches.push_back({q.value(0).toString(),
+                           q.value(1).toString(),
+                           relevance / (relevance + 1.)});
+    }
+    return matches;
+}
+
+optional<QString> SnippetDatabase::body(const QString &name) const
+{
+    QSqlQuery q(connection());
+    q.prepare(u"SELECT body FROM snippets WHERE name = ?"_s);
+    q.addBindValue(name);
+    if (q.exec() && q.next())
+        return q.value(0).toString();
+    if (q.lastError().isValid())
+        WARN << "Snippet database read failed:" << q.lastError().text();
+    return {};
+}
+
+bool SnippetDatabase::put(const QString &name, const QString &body)
+{
+    QSqlQuery q(connection());
+    q.prepare(upsert);
+    q.addBindValue(name);
+    q.addBindValue(body);
+    q.addBindValue(QDateTime::currentSecsSinceEpoch());
+    if (q.exec())
+        return true;
+    WARN << "Snippet database write failed:" << q.lastError().text();
+    return false;
+}
+
+bool SnippetDatabase::remove(const QString &name)
+{
+    QSqlQuery q(connection());
+    q.prepare(u"DELETE FROM snippets WHERE name = ?"_s);
+    q.addBindValue(name);
+    if (q.exec())
+        return true;
+    WARN << "Snippet database delete failed:" << q.lastError().text();
+    return false;
+}
+
+qsizetype SnippetDatabase::import(const QString &dir)
+{
+    auto db = connection();
+    if (!db.transaction())
+    {
+        WARN << "Snippet database import failed:" << db.lastError().text();
+        return -1;
+    }
+
+    QSqlQuery q(db);
+    q.prepare(upsert);
+
+    const QDir root(dir);
+    qsizetype count = 0;
+    for (QDirIterator it(dir, {u"*.txt"_s}, QDir::Files, QDirIterator::Subdirectories);
+         it.hasNext();)
+    {
+        const auto path = it.next();
+        const auto s = readSnippet(path);
+        if (!s.error.isEmpty())
+        {
+            WARN << "Skipping unreadable snippet file" << path << s.error;
+            continue;
+        }
+
+        q.addBindValue(root.relativeFilePath(path).chopped(4));
+        q.addBindValue(s.text);
+        q.addBindValue(it.fileInfo().lastModified().toSecsSinceEpoch());
+        if (!q.exec())
+        {
+            WARN << "Snippet database import failed:" << q.lastError().text();
+            db.rollback();
+            return -1;
+        }
+        ++count;
+    }
+
+    if (!db.commit())
+    {
+        WARN << "Snippet database import failed:" << db.lastError().text();
+        return -1;
+    }
+    return count;
+}
+
+qsizetype SnippetDatabase::size() const
+{
+    QSqlQuery q(connection());
+    if (q.exec(u"SELECT count(*) FROM snippets"_s) && q.next())
+        return q.value(0).toLongLong();
+    return 0;
+}
+
+QSet<QString> SnippetDatabase::names() const
+{
+    QSet<QString> names;
+    QSqlQuery q(connection());
+    q.setForwardOnly(true);
+    if (!q.exec(u"SELECT name FROM snippets"_s))
+        WARN << "Snippet database read failed:" << q.lastError().text();
+    while (q.next())
+        names.insert(q.value(0).toString());
+    return names;
+}
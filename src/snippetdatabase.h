@@ -0,0 +1,65 @@
+// Copyright (c) 2025 Manuel Schneider
+
+#pragma once
+#include <QSet>
+#include <QSqlDatabase>
+#include <QString>
+#include <optional>
+#include <vector>
+
+///
+/// SQLite backed snippet store with FTS5 full text search.
+///
+/// Meant for libraries too large for a directory of files. The database runs
+/// in WAL mode, so searches never block writes and vice versa. Each thread
+/// uses its own connection, which is closed when the thread finishes.
+///
+/// Thread-safe.
+///
+class SnippetDatabase
+{
+public:
+
+    explicit SnippetDatabase(const QString &path);
+    ~SnippetDatabase();
+
+    /// Empty if the database is usable.
+    const QString &error() const;
+
+    struct Match
+    {
+        QString name;
+        QString preview;  // Prefix of the body
+        double score;  // (0, 1), name matches weigh more than body matches
+    };
+
+    /// Returns the best `limit` matches of the words in `query`, each word
+    /// matching as prefix.
+    std::vector<Match> search(const QString &query, int limit) const;
+
+    std::optional<QString> body(const QString &name) const;
+
+    /// Inserts or replaces the snippet `name`.
+    bool put(const QString &name, const QString &body);
+
+    bool remove(const QString &name);
+
+    /// Inserts or replaces the *.txt snippets of the directory tree at `dir`
+    /// in a single transaction. Returns the number of imported snippets or -1
+    /// on failure. Names are relative paths without suffix.
+    qsizetype import(const QString &dir);
+
+    qsizetype size() const;
+
+    /// The names of all snippets.
+    QSet<QString> names() const;
+
+private:
+
+    QSqlDatabase connection() const;
+
+    const QString path_;
+    const quint64 serial_;  // Identifies the connections of this database
+    QString error_;
+
+};
@@ -0,0 +1,190 @@
+// Copyright (c) 2025 Manuel Schneider
+
+#include "snippetpack.h"
+#include <QSaveFile>
+#include <QtEndian>
+#include <algorithm>
+#include <albert/logging.h>
+#include <cstring>
+#include <limits>
+using namespace Qt::StringLiterals;
+using namespace std;
+
+namespace
+{
+
+struct Header
+{
+    char magic[4];
+    quint32_le version;
+    quint32_le count;
+    quint32_le reserved;
+};
+
+struct Record
+{
+    quint64_le name_offset;
+    quint64_le body_offset;
+    quint32_le name_size;
+    quint32_le body_size;
+};
+
+static_assert(sizeof(Header) == 16);
+static_assert(sizeof(Record) == 24);
+
+const char magic[4] = {'S', 'N', 'P', 'K'};
+const quint32 version = 1;
+
+}
+
+SnippetPack::SnippetPack(const QString &path) : file_(path)
+{
+    if (!file_.open(QIODevice::ReadOnly))
+    {
+        error_ = file_.errorString();
+        return;
+    }
+
+    const auto size = file_.size();
+    const uchar *data = size ? file_.map(0, size) : nullptr;
+    if (!data)
+    {
+        error_ = size ? file_.errorString() : u"Empty file"_s;
+        return;
+    }
+    data_ = QByteArrayView(data, size);
+
+    Header header{};
+    if (size >= qint64(sizeof(Header)))
+        memcpy(&header, data, sizeof(Header));
+
+    if (memcmp(header.magic, magic, sizeof(magic)) != 0
+        || header.version != version
+        || size < qint64(sizeof(Header)) + qint64(header.count) * qint64(sizeof(Record)))
+    {
+        error_ = u"Not a snippet pack of version %1"_s.arg(version);
+        return;
+    }
+
+    count_ = header.count;
+}
+
+const QString &SnippetPack::error() const { return error_; }
+
+qsizetype SnippetPack::size() const { return count_; }
+
+QByteArrayView SnippetPack::bytes(quint64 offset, quint64 size) const
+{
+    // Out of range records of corrupt packs yield empty views
+    if (offset > quint64(data_.size()) || size > quint64(data_.size()) - offset)
+        return {};
+    return data_.sliced(qsizetype(offset), qsizetype(size));
+}
+
+static Record record(QByteArrayView data, qsizetype i)
+{
+    Record r;
+    memcpy(&r, data.data() + sizeof(Header) + i * sizeof(Record), sizeof(Record));
+    return r;
+}
+
+QString SnippetPack::name(qsizetype i) const
+{
+    const auto r = record(data_, i);
+    return QString::fromUtf8(bytes(r.name_offset, r.name_size));
+}
+
+QByteArrayView SnippetPack::body(qsizetype i) const
+{
+    const auto r = record(data_, i);
+    return bytes(r.body_offset, r.body_size);
+}
+
+qsizetype SnippetPack::find(const QString &name) const
+{
+    const auto key = name.toUtf8();
+    qsizetype lo = 0, hi = count_;
+    while (lo < hi)
+    {
+        const auto mid = lo + (hi - lo) / 2;
+        const auto r = record(data_, mid);
+        const auto c = bytes(r.name_offset, r.name_size).compare(key);
+        if (c == 0)
+            return mid;
+        else if (c < 0)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return -1;
+}
+
+bool writeSnippetPack(const QString &path, vector<pair<QString, QByteArray>> snippets)
+{
+    vector<pair<QByteArray, QByteArray>> entries;
+    entries.reserve(snippets.size());
+    for (auto &[name, body] : snippets)
+    {
+        if (name.isEmpty() || name.contains(u'/') || body.size() > numeric_limits<quint32>::max())
+        {
+            WARN << "Invalid snippet pack entry" << name;
+            return false;
+        }
+        entries.emplace_back(name.toUtf8(), ::move(body));
+    }
+
+    // Sorted by UTF-8 bytes, matching find()
+    sort(entries.begin(), entries.end(),
+         [](const auto &a, const auto &b){ return a.first < b.first; });
+    if (adjacent_find(entries.begin(), entries.end(),
+                      [](const auto &a, const auto &b){ return a.first == b.first; })
+        != entries.end())
+    {
+        WARN << "Duplicate snippet pack entry names";
+        return false;
+    }
+
+    Header header;
+    memcpy(header.magic, magic, sizeof(magic));
+    header.version = version;
+    header.count = quint32(entries.size());
+    header.reserved = 0;
+
+    vector<Record> records;
+    records.reserve(entries.size());
+    quint64 offset = sizeof(Header) + entries.size() * sizeof(Record);
+    for (const auto &[name, body] : entries)
+    {
+        Record r;
+        r.name_offset = offset;
+        r.name_size = quint32(name.size());
+        offset += quint64(name.size());
+        r.body_offset = offset;
+        r.body_size = quint32(body.size());
+        offset += quint64(body.size());
+        records.push_back(r);
+    }
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        WARN << "Failed to write snippet pack" << path << file.errorString();
+        return false;
+    }
+
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char *>(records.data()),
+               qint64(records.size() * sizeof(Record)));
+    for (const auto &[name, body] : entries)
+    {
+        file.write(name);
+        file.write(body);
+    }
+
+    if (!file.commit())
+    {
+        WARN << "Failed to write snippet pack" << path << file.errorString();
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,58 @@
+// Copyright (c) 2025 Manuel Schneider
+
+#pragma once
+#include <QByteArrayView>
+#include <QFile>
+#include <QString>
+#include <utility>
+#include <vector>
+
+///
+/// Read-only view of a snippet pack file.
+///
+/// A pack holds many snippets in one file: a header, a table of entries
+/// sorted by name, then the UTF-8 names and bodies. All integers are little
+/// endian. The file is memory mapped and snippets are addressed by offset,
+/// so reading one snippet touches its byte range only.
+///
+/// Thread-safe.
+///
+class SnippetPack
+{
+public:
+
+    static inline const QString suffix = QStringLiteral(".snippets");
+
+    /// Opens and maps the pack at `path`. Check error() before use.
+    explicit SnippetPack(const QString &path);
+
+    /// Empty if the pack is valid.
+    const QString &error() const;
+
+    qsizetype size() const;
+
+    QString name(qsizetype i) const;
+
+    /// The UTF-8 body of entry `i`, valid as long as the pack lives.
+    QByteArrayView body(qsizetype i) const;
+
+    /// Binary searches the entry named `name`. Returns -1 if not found.
+    qsizetype find(const QString &name) const;
+
+private:
+
+    QByteArrayView bytes(quint64 offset, quint64 size) const;
+
+    QFile file_;
+    QByteArrayView data_;
+    qsizetype count_ = 0;
+    QString error_;
+
+};
+
+///
+/// Writes the `snippets` (name, UTF-8 body) to a pack at `path`.
+///
+/// Names must be unique and must not contain '/'. Returns false on failure.
+///
+bool writeSnippetPack(const QString &path, std::vector<std::pair<QString, QByteArray>> snippets);
@@ -0,0 +1,142 @@
+// Copyright (c) 2025 Manuel Schneider
+
+#include "contentindex.h"
+#include "snippetreader.h"
+#include "trigramindex.h"
+#include <QFile>
+#include <QStringDecoder>
+#include <albert/logging.h>
+#include <algorithm>
+using namespace Qt::StringLiterals;
+
+static const qsizetype decode_chunk_size = 1024 * 1024;
+static const qsizetype index_chunk_size = 64 * 1024;  // Bounds the abort latency
+static const auto aborted = u"Aborted"_s;
+
+SnippetText readSnippet(const QString &path, const ReadProgress &progress)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return {{}, file.errorString()};
+
+    const auto size = file.size();
+    if (size == 0)
+        return {};
+
+    if (const uchar *data = file.map(0, size); data)
+    {
+        auto s = decodeSnippet(QByteArrayView(data, size), path, progress);
+        file.unmap(const_cast<uchar *>(data));
+        return s;
+    }
+
+    const auto bytes = file.readAll();
+    if (file.error() != QFileDevice::NoError)
+        return {{}, file.errorString()};
+    return decodeSnippet(bytes, path, progress);
+}
+
+SnippetText decodeSnippet(QByteArrayView bytes, const QString &origin,
+                          const ReadProgress &progress)
+{
+    QStringDecoder decoder(QStringDecoder::Utf8);
+    QString text;
+
+    if (!progress)
+        text = decoder(bytes);
+    else
+    {
+        // The decoder is stateful, sequences split across chunks are fine
+        text.reserve(bytes.size());
+        for (qsizetype done = 0; done < bytes.size();)
+        {
+            const auto chunk = bytes.sliced(done, qMin(decode_chunk_size, bytes.size() - done));
+            text.append(decoder(chunk));
+            done += chunk.size();
+            if (!progress(done, bytes.size()))
+                return {{}, u"Canceled"_s};
+        }
+    }
+
+    if (decoder.hasError())
+        WARN << "Snippet contains invalid UTF-8:" << origin;
+
+    return {text, {}};
+}
+
+// The prefix needed by the enabled indexes
+static qint64 indexedBytes(const IndexLimits &limits)
+{ return std::max<qint64>(limits.fulltext_bytes, limits.substring_bytes); }
+
+SnippetIndexData readIndexData(const QString &path, const IndexLimits &limits,
+                               IndexStats *stats, const bool *abort)
+{
+    if (indexedBytes(limits) <= 0)
+        return {};
+
+    QFile file(path);
+    QByteArray bytes;
+    {
+        IndexStats::Timer t(stats, IndexStats::Open);
+        if (!file.open(QIODevice::ReadOnly))
+            return {.error = file.errorString()};
+
+        const auto size = std::min(file.size(), indexedBytes(limits));
+        bytes.resize(size);
+        for (qint64 done = 0; done < size;)
+        {
+            if (abort && *abort)
+                return {.error = aborted};
+
+            const auto n = file.read(bytes.data() + done,
+                                     std::min<qint64>(index_chunk_size, size - done));
+            if (n <= 0)  // Error or truncated meanwhile
+            {
+                bytes.truncate(done);
+                break;
+            }
+            done += n;
+        }
+    }
+
+    return indexData(bytes, limits, stats, abort);
+}
+
+SnippetIndexData indexData(QByteArrayView bytes, const IndexLimits &limits, IndexStats *stats,
+                           const bool *abort)
+{
+    if (indexedBytes(limits) <= 0)
+        return {};
+
+    QString content;
+    qsizetype fulltext_size = 0;  // Characters of the word indexed prefix
+    {
+        IndexStats::Timer t(stats, IndexStats::Decode);
+        bytes = bytes.first(std::min<qint64>(bytes.size(), indexedBytes(limits)));
+        const auto fulltext_bytes = std::clamp<qint64>(limits.fulltext_bytes, 0, bytes.size());
+        QStringDecoder decoder(QStringDecoder::Utf8);
+        content.reserve(bytes.size());
+        for (qsizetype done = 0; done < bytes.size();)
+        {
+            if (abort && *abort)
+                return {.error = aborted};
+
+            // Chunks end at the fulltext limit, the characters before it are word indexed
+            const auto end = done < fulltext_bytes ? fulltext_bytes : bytes.size();
+            const auto n = std::min<qint64>(index_chunk_size, end - done);
+            content.append(decoder(bytes.sliced(done, n)));
+            if ((done += n) == fulltext_bytes)
+                fulltext_size = content.size();
+        }
+    }
+
+    IndexStats::Timer t(stats, IndexStats::Tokenize);
+    SnippetIndexData d;
+    if (limits.fulltext_bytes > 0)
+        d.terms = ContentIndex::terms(content.first(fulltext_size), abort);
+    if (abort && *abort)
+        return {.error = aborted};
+    if (limits.substring_bytes > 0)
+        d.text = TrigramIndex::normalize(content, limits.substring_bytes);
+    return d;
+}
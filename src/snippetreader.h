@@ -0,0 +1,73 @@
+// Copyright (c) 2025 Manuel Schneider
+
+#pragma once
+#include "indexstats.h"
+#include <QByteArray>
+#include <QString>
+#include <functional>
+
+struct SnippetText
+{
+    QString text;
+    QString error;  // Empty on success
+};
+
+/// Receives the decoded and total bytes, returns false to cancel.
+using ReadProgress = std::function<bool(qint64 done, qint64 total)>;
+
+///
+/// Reads the snippet file at `path`.
+///
+/// The file is mapped into memory and decoded from UTF-8 in a single pass,
+/// without intermediate buffers. Invalid UTF-8 sequences are replaced and
+/// logged. Files that can not be mapped are read conventionally.
+///
+/// If `progress` is set, decodes in chunks and reports the progress after
+/// each chunk. A canceled read returns an error.
+///
+/// Thread-safe.
+///
+SnippetText readSnippet(const QString &path, const ReadProgress &progress = {});
+
+///
+/// Decodes the UTF-8 `bytes` of a snippet, e.g. a snippet pack entry.
+///
+/// `origin` names the snippet in warnings. See readSnippet() for `progress`.
+/// Thread-safe.
+///
+SnippetText decodeSnippet(QByteArrayView bytes, const QString &origin,
+                          const ReadProgress &progress = {});
+
+struct IndexLimits
+{
+    qint64 fulltext_bytes;  // Word indexed prefix, zero disables word search
+    qsizetype substring_bytes;  // Trigram indexed prefix, zero disables substring search
+};
+
+struct SnippetIndexData
+{
+    QByteArray terms;  // See ContentIndex::terms()
+    QByteArray text;  // See TrigramIndex::normalize()
+    QString error;  // Empty on success
+};
+
+///
+/// Reads the data needed to index the snippet file at `path`.
+///
+/// Does not open the file if both word and substring search are disabled.
+/// Previews are not part of the index data, see readPreview(). Records the
+/// phase timings to `stats` if not null. Thread-safe.
+///
+/// Reads, decodes and tokenizes in chunks and checks `abort`, if set, after
+/// each chunk. Aborted reads return an error.
+///
+SnippetIndexData readIndexData(const QString &path, const IndexLimits &limits,
+                               IndexStats *stats = nullptr, const bool *abort = nullptr);
+
+///
+/// Computes the index data of the UTF-8 `bytes` of a snippet.
+///
+/// Like readIndexData() for snippets already in memory.
+///
+SnippetIndexData indexData(QByteArrayView bytes, const IndexLimits &limits,
+                           IndexStats *stats = nullptr, const bool *abort = nullptr);
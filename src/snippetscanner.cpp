@@ -0,0 +1,207 @@
+// Copyright (c) 2025 Manuel Schneider
+
+#include "snippetpack.h"
+#include "snippetscanner.h"
+#include <QDirIterator>
+#include <QThreadPool>
+#include <QtConcurrentMap>
+#include <albert/logging.h>
+#include <vector>
+using namespace Qt::StringLiterals;
+using namespace std;
+
+static IndexEntry readEntry(const QString &path, const FileStamp &stamp,
+                            const ScanContext &context, const bool &abort)
+{
+    auto d = readIndexData(path, context.limits, context.stats, &abort);
+    if (!d.error.isEmpty() && !abort)
+        WARN << "Failed to read from snippet file" << path << d.error;
+
+    return {stamp, ::move(d.terms), ::move(d.text)};
+}
+
+static vector<pair<QString, IndexEntry>> readPack(const QString &relative_path,
+                                                   const QString &path, const FileStamp &stamp,
+                                                   const ScanContext &context,
+                                                   const bool &abort)
+{
+    const SnippetPack pack(path);
+    if (!pack.error().isEmpty())
+    {
+        WARN << "Failed to read snippet pack" << path << pack.error();
+        return {};
+    }
+
+    vector<pair<QString, IndexEntry>> entries;
+    entries.reserve(pack.size());
+    for (qsizetype i = 0; i < pack.size(); ++i)
+    {
+        if (abort)
+            return {};
+
+        const auto name = pack.name(i);
+        if (name.isEmpty() || name.contains(u'/'))
+        {
+            WARN << "Skipping invalid entry name in snippet pack" << path << name;
+            continue;
+        }
+
+        auto d = indexData(pack.body(i), context.limits, context.stats, &abort);
+        entries.emplace_back(relative_path + u'/' + name,
+                             IndexEntry{stamp, ::move(d.terms), ::move(d.text)});
+    }
+    return entries;
+}
+
+bool isPack(const QString &relative_path) { return relative_path.endsWith(SnippetPack::suffix); }
+
+pair<IndexTable::const_iterator, IndexTable::const_iterator>
+entriesBelow(const IndexTable &table, const QString &relative_path)
+{
+    // Keys between "<path>/" and "<path>0", since '0' follows '/'
+    return {table.lower_bound(relative_path + u'/'), table.lower_bound(relative_path + u'0')};
+}
+
+size_t eraseSnippetFile(IndexTable &table, const QString &relative_path)
+{
+    if (!isPack(relative_path))
+        return table.erase(relative_path);
+
+    const auto [begin, end] = entriesBelow(table, relative_path);
+    const auto count = size_t(distance(begin, end));
+    table.erase(begin, end);
+    return count;
+}
+
+QStringList listSnippetFiles(const ScanContext &context, const QStringList &roots,
+                             const bool &abort)
+{
+    IndexStats::Timer t(context.stats, IndexStats::Enumerate);
+
+    struct Listing
+    {
+        QStringList files;
+        QStringList dirs;
+    };
+
+    auto list = [&](const QString &rel)
+    {
+        Listing l;
+        const auto prefix = rel.isEmpty() ? QString() : rel + u'/';
+        for (QDirIterator it(context.dir + u'/' + rel, {u"*.txt"_s, u'*' + SnippetPack::suffix},
+                             QDir::Files | QDir::AllDirs | QDir::NoDotAndDotDot);
+             it.hasNext() && !abort;)
+        {
+            it.next();
+            if (const auto fi = it.fileInfo(); !fi.isDir())
+                l.files << prefix + it.fileName();
+            else if (!fi.isSymLink() && !isPack(it.fileName()))
+                l.dirs << prefix + it.fileName();
+        }
+        return l;
+    };
+
+    QStringList level;
+    for (const auto &root : roots)
+        if (!isPack(root))
+            level << root;
+
+    QStringList file_names;
+    while (!level.isEmpty())
+    {
+        const auto listings = QtConcurrent::blockingMapped<QList<Listing>>(context.pool, level, list);
+        if (abort) return {};
+
+        level.clear();
+        for (const auto &l : listings)
+        {
+            file_names << l.files;
+            level << l.dirs;
+        }
+    }
+
+    file_names.removeDuplicates();  // Nested roots
+    return file_names;
+}
+
+optional<ScanResult> scanSnippetFiles(const ScanContext &context,
+                                      const QStringList &file_names,
+                                      const IndexTable &previous,
+                                      IndexTable table,
+                                      const bool &abort,
+                                      const vector<optional<FileStamp>> &stamps)
+{
+    struct Chunk
+    {
+        qsizetype begin;
+        qsizetype end;
+        vector<pair<QString, IndexEntry>> entries{};
+        size_t reused = 0;
+    };
+
+    const auto threads = max(1, context.pool->maxThreadCount());
+    const auto chunk_size = max<qsizetype>(64, file_names.size() / (threads * 4));
+    vector<Chunk> chunks;
+    for (qsizetype i = 0; i < file_names.size(); i += chunk_size)
+        chunks.push_back({i, min(i + chunk_size, file_names.size())});
+
+    QtConcurrent::blockingMap(context.pool, chunks, [&](Chunk &chunk)
+    {
+        chunk.entries.reserve(chunk.end - chunk.begin);
+        for (auto i = chunk.begin; i < chunk.end; ++i)
+        {
+            if (abort) return;
+
+            const auto &file_name = file_names[i];
+            const auto path = context.dir + u'/' + file_name;
+            optional<FileStamp> stamp;
+            if (!stamps.empty())
+                stamp = stamps[i];
+            else
+            {
+                IndexStats::Timer t(context.stats, IndexStats::Stat);
+                stamp = FileStamp::of(path);
+            }
+            if (!stamp)
+            {
+                WARN << "Failed to stat snippet file" << path;
+                continue;
+            }
+
+            if (isPack(file_name))
+            {
+                if (const auto [begin, end] = entriesBelow(previous, file_name);
+                    begin != end && begin->second.stamp == *stamp)
+                {
+                    chunk.entries.insert(chunk.entries.end(), begin, end);
+                    chunk.reused += size_t(distance(begin, end));
+                }
+                else
+                    for (auto &e : readPack(file_name, path, *stamp, context, abort))
+                        chunk.entries.push_back(::move(e));
+            }
+            else if (const auto old = previous.find(file_name);
+                     old != previous.end() && old->second.stamp == *stamp)
+            {
+                chunk.entries.emplace_back(file_name, old->second);
+                ++chunk.reused;
+            }
+            else
+                chunk.entries.emplace_back(file_name, readEntry(path, *stamp, context, abort));
+        }
+    });
+
+    if (abort) return {};
+
+    IndexStats::Timer t(context.stats, IndexStats::Merge);
+    ScanResult result{::move(table)};
+    result.chunks = chunks.size();
+    for (auto &chunk : chunks)
+    {
+        result.scanned += chunk.entries.size();
+        result.reused += chunk.reused;
+        for (auto &[file_name, entry] : chunk.entries)
+            result.table.insert_or_assign(::move(file_name), ::move(entry));
+    }
+    return result;
+}
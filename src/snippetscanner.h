@@ -0,0 +1,84 @@
+// Copyright (c) 2025 Manuel Schneider
+
+#pragma once
+#include "filestamp.h"
+#include "indexstats.h"
+#include "snippetreader.h"
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+#include <map>
+#include <optional>
+#include <vector>
+class QThreadPool;
+
+struct IndexEntry
+{
+    FileStamp stamp;
+    QByteArray terms;
+    QByteArray text;
+    qsizetype slot = -1;  // Item built by the plugin, -1 until then
+};
+
+/// Relative path -> entry. Pack entries are keyed "<pack relative path>/<entry name>".
+using IndexTable = std::map<QString, IndexEntry>;
+
+struct ScanContext
+{
+    QString dir;
+    IndexLimits limits;
+    QThreadPool *pool;
+    IndexStats *stats = nullptr;  // Records the phase timings if not null
+};
+
+struct ScanResult
+{
+    IndexTable table;
+    size_t scanned = 0;
+    size_t reused = 0;
+    size_t chunks = 0;
+};
+
+/// True if `relative_path` names a snippet pack.
+bool isPack(const QString &relative_path);
+
+/// The entries of the pack or directory at `relative_path`.
+std::pair<IndexTable::const_iterator, IndexTable::const_iterator>
+entriesBelow(const IndexTable &table, const QString &relative_path);
+
+/// Erases the entries of the snippet file or pack at `relative_path` and
+/// returns their number.
+size_t eraseSnippetFile(IndexTable &table, const QString &relative_path);
+
+///
+/// Lists the snippet files and packs in the trees at `roots`.
+///
+/// Walks the trees level by level and lists the directories of a level in
+/// parallel. Hidden, symlinked and pack named directories are skipped, the
+/// latter because their ids would be ambiguous. Roots and returned paths
+/// are relative to the snippet directory, the empty root is the snippet
+/// directory itself.
+///
+/// Returns an empty list if aborted.
+///
+QStringList listSnippetFiles(const ScanContext &context, const QStringList &roots,
+                             const bool &abort);
+
+///
+/// Stats and reads the snippet files and packs `file_names` in parallel chunks.
+///
+/// The entries of unchanged files are reused from `previous`, added or
+/// modified files are read. A pack is reused or read as a whole, all of its
+/// entries carry the stamp of the pack. The entries are merged into
+/// `table`, replacing existing ones. `previous` must not be modified while
+/// scanning. If `stamps` is not empty, it holds the stamps of `file_names`,
+/// which are not statted again then.
+///
+/// Returns nothing if aborted.
+///
+std::optional<ScanResult> scanSnippetFiles(const ScanContext &context,
+                                           const QStringList &file_names,
+                                           const IndexTable &previous,
+                                           IndexTable table,
+                                           const bool &abort,
+                                           const std::vector<std::optional<FileStamp>> &stamps = {});
@@ -0,0 +1,75 @@
+// Copyright (c) 2025 Manuel Schneider
+
+#include "snippetstore.h"
+using namespace std;
+
+SnippetStore::SnippetStore(const vector<Snippet> &snippets)
+{
+    vector<QByteArray> utf8;
+    utf8.reserve(snippets.size() * 2);
+    qsizetype arena_size = 0;
+    for (const auto &s : snippets)
+        for (const auto *str : {&s.id, &s.preview})
+            arena_size += utf8.emplace_back(str->toUtf8()).size();
+
+    arena_.reserve(arena_size);
+    offsets_.reserve(utf8.size() + 1);
+    for (const auto &bytes : utf8)
+    {
+        offsets_.push_back(quint32(arena_.size()));
+        arena_.append(bytes);
+    }
+    offsets_.push_back(quint32(arena_.size()));
+}
+
+qsizetype SnippetStore::size() const { return qsizetype(offsets_.size() / 2); }
+
+QByteArrayView SnippetStore::slice(qsizetype n) const
+{ return QByteArrayView(arena_).sliced(offsets_[n], offsets_[n + 1] - offsets_[n]); }
+
+QString SnippetStore::id(qsizetype i) const { return QString::fromUtf8(slice(2 * i)); }
+
+QString SnippetStore::name(qsizetype i) const
+{
+    const auto id = slice(2 * i);
+    return QString::fromUtf8(id.sliced(id.lastIndexOf('/') + 1));
+}
+
+QString SnippetStore::preview(qsizetype i, const function<QString()> &read) const
+{
+    if (const auto known = slice(2 * i + 1); !known.isEmpty())
+        return QString::fromUtf8(known);
+
+    {
+        lock_guard lock(mutex_);
+        if (const auto it = read_previews_.find(quint32(i)); it != read_previews_.end())
+            return it->second;
+    }
+
+    // Read without holding the lock, concurrent readers of the same preview
+    // are rare and agree on the result
+    auto preview = read();
+    preview.squeeze();
+
+    lock_guard lock(mutex_);
+    return read_previews_.try_emplace(quint32(i), ::move(preview)).first->second;
+}
+
+QString SnippetStore::knownPreview(qsizetype i) const
+{
+    if (const auto known = slice(2 * i + 1); !known.isEmpty())
+        return QString::fromUtf8(known);
+
+    lock_guard lock(mutex_);
+    const auto it = read_previews_.find(quint32(i));
+    return it == read_previews_.end() ? QString() : it->second;
+}
+
+qsizetype SnippetStore::memoryUsage() const
+{
+    lock_guard lock(mutex_);
+    qsizetype usage = arena_.capacity() + qsizetype(offsets_.capacity() * sizeof(quint32));
+    for (const auto &[i, preview] : read_previews_)
+        usage += qsizetype(sizeof(preview) + 2 * sizeof(void *)) + preview.capacity() * 2;
+    return usage;
+}
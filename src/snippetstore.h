@@ -0,0 +1,58 @@
+// Copyright (c) 2025 Manuel Schneider
+
+#pragma once
+#include <QByteArray>
+#include <QString>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+///
+/// Columnar storage of snippet ids and previews.
+///
+/// Ids and known previews live in a single UTF-8 arena addressed by an offset
+/// array, instead of two heap allocated strings per snippet. Previews that are
+/// not known at construction are read on demand and kept in a side table, so
+/// their memory stays proportional to what has been displayed.
+///
+/// Immutable except for the lazily read previews. Thread-safe.
+///
+class SnippetStore
+{
+public:
+
+    struct Snippet
+    {
+        QString id;  // Relative path without suffix
+        QString preview;  // Empty if not known
+    };
+
+    explicit SnippetStore(const std::vector<Snippet> &snippets);
+
+    qsizetype size() const;
+
+    QString id(qsizetype i) const;
+
+    /// The last component of the id.
+    QString name(qsizetype i) const;
+
+    /// Returns the preview of snippet `i`, calling `read` if not known yet.
+    QString preview(qsizetype i, const std::function<QString()> &read) const;
+
+    /// Returns the preview of snippet `i` if known, without reading it.
+    QString knownPreview(qsizetype i) const;
+
+    /// Approximate heap usage in bytes.
+    qsizetype memoryUsage() const;
+
+private:
+
+    QByteArrayView slice(qsizetype n) const;
+
+    QByteArray arena_;
+    std::vector<quint32> offsets_;  // Id i is slice 2i, preview i is slice 2i+1
+    mutable std::mutex mutex_;
+    mutable std::unordered_map<quint32, QString> read_previews_;
+
+};
@@ -0,0 +1,108 @@
+// Copyright (c) 2025 Manuel Schneider
+
+#include "snippettemplate.h"
+using namespace Qt::StringLiterals;
+using namespace std;
+
+// Bounds the search for the closing brace, keeps parsing linear
+static const qsizetype max_placeholder_size = 128;
+
+SnippetTemplate::SnippetTemplate(const QString &text) : text_(text)
+{
+    const auto size = text.size();
+    qsizetype literal = 0;  // Begin of the pending literal
+
+    for (qsizetype i = 0; i < size; ++i)
+    {
+        if (text[i] != u'{')
+            continue;
+
+        const auto end = min(size, i + max_placeholder_size);
+        qsizetype close = i + 1;
+        while (close < end && text[close] != u'}' && text[close] != u'{' && text[close] != u'\n')
+            ++close;
+        if (close == end || text[close] != u'}')
+            continue;
+
+        const auto body = QStringView(text).sliced(i + 1, close - i - 1);
+        const auto colon = body.indexOf(u':');
+        const auto name = colon < 0 ? body : body.first(colon);
+        const auto arg_offset = colon < 0 ? close : i + 1 + colon + 1;
+        const auto arg_length = close - arg_offset;
+
+        Op op;
+        if (name == u"date"_s)
+            op = Op::Date;
+        else if (name == u"clipboard"_s && colon < 0)
+            op = Op::Clipboard;
+        else if (name == u"env"_s && arg_length > 0)
+            op = Op::Env;
+        else
+            continue;
+
+        if (i > 0 && text[i - 1] == u'{')
+        {
+            // Escaped, drop one brace and keep the placeholder literally
+            if (literal < i - 1)
+                program_.push_back({Op::Literal, literal, i - 1 - literal});
+            literal = i;
+            i = close;
+            continue;
+        }
+
+        if (literal < i)
+            program_.push_back({Op::Literal, literal, i - literal});
+        program_.push_back({op, arg_offset, arg_length});
+        literal = close + 1;
+        i = close;
+    }
+
+    if (literal < size)
+        program_.push_back({Op::Literal, literal, size - literal});
+}
+
+QString SnippetTemplate::expand(const Context &context) const
+{
+    if (isStatic())
+        return text_;  // Shares the data
+
+    QString text;
+    text.reserve(text_.size());
+    optional<QString> clipboard;
+
+    for (const auto &t : program_)
+    {
+        const auto arg = QStringView(text_).sliced(t.offset, t.length);
+        switch (t.op)
+        {
+        case Op::Literal:
+            text.append(arg);
+            break;
+        case Op::Date:
+            text.append(arg.isEmpty() ? context.now.toString(Qt::ISODate)
+                                      : context.now.toString(arg));
+            break;
+        case Op::Clipboard:
+            if (!clipboard)
+                clipboard = context.clipboard ? context.clipboard() : QString();
+            text.append(*clipboard);
+            break;
+        case Op::Env:
+            text.append(qEnvironmentVariable(arg.toLocal8Bit().constData()));
+            break;
+        }
+    }
+
+    return text;
+}
+
+const QString &SnippetTemplate::text() const { return text_; }
+
+bool SnippetTemplate::isStatic() const
+{ return program_.empty() || (program_.size() == 1 && program_[0].op == Op::Literal); }
+
+qsizetype SnippetTemplate::memoryUsage() const
+{
+    return text_.capacity() * qsizetype(sizeof(QChar))
+           + qsizetype(program_.capacity() * sizeof(Token));
+}
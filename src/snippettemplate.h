@@ -0,0 +1,60 @@
+// Copyright (c) 2025 Manuel Schneider
+
+#pragma once
+#include <QDateTime>
+#include <QString>
+#include <functional>
+#include <vector>
+
+///
+/// A snippet compiled into a token program for placeholder expansion.
+///
+/// Supported placeholders:
+///  - `{date}`, `{date:<format>}`: The current local time, ISO 8601 or in
+///    the QDateTime::toString() `format`.
+///  - `{clipboard}`: The clipboard text.
+///  - `{env:<name>}`: The environment variable `name`.
+///
+/// A doubled opening brace escapes a placeholder, e.g. `{{date}` yields
+/// `{date}`. Anything else, including unknown placeholders, is copied
+/// verbatim. Parsing happens once on construction, expansion is a single
+/// linear pass.
+///
+class SnippetTemplate
+{
+public:
+
+    explicit SnippetTemplate(const QString &text);
+
+    struct Context
+    {
+        QDateTime now = QDateTime::currentDateTime();
+        std::function<QString()> clipboard = {};  // Called at most once
+    };
+
+    QString expand(const Context &context) const;
+
+    /// The text as passed on construction.
+    const QString &text() const;
+
+    /// True if the text contains no placeholders.
+    bool isStatic() const;
+
+    /// Approximate heap usage in bytes.
+    qsizetype memoryUsage() const;
+
+private:
+
+    enum class Op : quint8 { Literal, Date, Clipboard, Env };
+
+    struct Token
+    {
+        Op op;
+        qsizetype offset;  // Literal or argument slice of text_
+        qsizetype length;
+    };
+
+    QString text_;
+    std::vector<Token> program_;
+
+};
@@ -0,0 +1,203 @@
+// Copyright (c) 2025 Manuel Schneider
+
+#include "snippetpack.h"
+#include "snippetwatcher.h"
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QSet>
+#include <QSocketNotifier>
+#include <albert/logging.h>
+#if defined(Q_OS_LINUX)
+#include <cerrno>
+#include <cstring>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+using namespace Qt::StringLiterals;
+
+#if defined(Q_OS_LINUX)
+static const uint32_t watch_mask = IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO
+                                   | IN_CLOSE_WRITE | IN_DELETE_SELF | IN_MOVE_SELF;
+#endif
+
+SnippetWatcher::SnippetWatcher(const QString &path, QObject *parent):
+    QObject(parent),
+    root(path)
+{
+#if defined(Q_OS_LINUX)
+    inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+
+    if (inotify_fd < 0)
+        WARN << "Failed to initialize inotify:" << strerror(errno);
+    else
+    {
+        watch({});
+        if (watches.key({}, -1) >= 0)
+        {
+            notifier = new QSocketNotifier(inotify_fd, QSocketNotifier::Read, this);
+            connect(notifier, &QSocketNotifier::activated, this, &SnippetWatcher::readEvents);
+            return;
+        }
+        ::close(inotify_fd);
+        inotify_fd = -1;
+        watches.clear();
+    }
+#endif
+
+    // Watch new subdirectories of the changed directory as they appear
+    connect(&fallback, &QFileSystemWatcher::directoryChanged, this, [this](const QString &path){
+        if (QFileInfo::exists(path))
+            watch(path == root.path() ? QString() : root.relativeFilePath(path));
+        emit directoryChanged();
+    });
+    watch({});
+}
+
+SnippetWatcher::~SnippetWatcher()
+{
+#if defined(Q_OS_LINUX)
+    if (inotify_fd >= 0)
+        ::close(inotify_fd);
+#endif
+}
+
+bool SnippetWatcher::isNative() const { return inotify_fd >= 0; }
+
+QString SnippetWatcher::absolutePath(const QString &relative_path) const
+{ return relative_path.isEmpty() ? root.path() : root.filePath(relative_path); }
+
+void SnippetWatcher::watch(const QString &relative_dir)
+{
+    const auto watched = fallback.directories();
+    QStringList fallback_paths;
+
+    for (QStringList dirs{relative_dir}; !dirs.isEmpty();)
+    {
+        const auto rel = dirs.takeLast();
+        const auto path = absolutePath(rel);
+
+#if defined(Q_OS_LINUX)
+        if (inotify_fd >= 0)
+        {
+            if (const int wd = inotify_add_watch(inotify_fd, QFile::encodeName(path).constData(),
+                                                 watch_mask); wd < 0)
+                WARN << "Failed to add inotify watch:" << path << strerror(errno);
+            else
+                watches.insert(wd, rel);
+        }
+        else
+#endif
+        if (!watched.contains(path))
+            fallback_paths << path;
+        else if (rel != relative_dir)
+            continue;  // Watched along with its subtree
+
+        for (QDirIterator it(path, QDir::Dirs | QDir::NoDotAndDotDot | QDir::NoSymLinks);
+             it.hasNext();)
+        {
+            it.next();
+            if (!it.fileName().endsWith(SnippetPack::suffix))  // Not scanned
+                dirs << (rel.isEmpty() ? it.fileName() : rel + u'/' + it.fileName());
+        }
+    }
+
+    if (!fallback_paths.isEmpty())
+        fallback.addPaths(fallback_paths);
+}
+
+void SnippetWatcher::unwatch(const QString &relative_dir)
+{
+#if defined(Q_OS_LINUX)
+    const auto prefix = relative_dir + u'/';
+    for (auto it = watches.begin(); it != watches.end();)
+        if (*it == relative_dir || it->startsWith(prefix))
+        {
+            inotify_rm_watch(inotify_fd, it.key());
+            it = watches.erase(it);
+        }
+        else
+            ++it;
+#else
+    Q_UNUSED(relative_dir)
+#endif
+}
+
+void SnippetWatcher::readEvents()
+{
+#if defined(Q_OS_LINUX)
+    alignas(inotify_event) char buf[16 * 1024];
+    QSet<QString> changed, removed, subtrees;
+    bool overflow = false;
+
+    for (ssize_t len; (len = ::read(inotify_fd, buf, sizeof(buf))) > 0;)
+    {
+        for (const char *p = buf; p < buf + len;)
+        {
+            const auto *ev = reinterpret_cast<const inotify_event *>(p);
+            p += sizeof(inotify_event) + ev->len;
+
+            if (ev->mask & IN_Q_OVERFLOW)
+            {
+                overflow = true;
+                continue;
+            }
+
+            const auto w = watches.constFind(ev->wd);
+            if (w == watches.cend())
+                continue;
+
+            const auto dir = *w;
+
+            if (ev->mask & IN_IGNORED)
+                watches.erase(w);
+
+            // Subdirectories are handled by the events of their parent
+            if (ev->mask & (IN_DELETE_SELF | IN_MOVE_SELF) && dir.isEmpty())
+                overflow = true;
+
+            if (ev->len == 0)
+                continue;
+
+            const auto name = QFile::decodeName(ev->name);
+            const auto rel = dir.isEmpty() ? name : dir + u'/' + name;
+
+            if (ev->mask & IN_ISDIR)
+            {
+                if (name.startsWith(u'.') || name.endsWith(SnippetPack::suffix))  // Not scanned
+                    continue;
+                else if (ev->mask & (IN_CREATE | IN_MOVED_TO))
+                    watch(rel);
+                else if (ev->mask & (IN_DELETE | IN_MOVED_FROM))
+                    unwatch(rel);
+                subtrees.insert(rel);
+            }
+
+            else if (!name.endsWith(u".txt"_s) && !name.endsWith(SnippetPack::suffix))
+                continue;
+
+            else if (ev->mask & (IN_DELETE | IN_MOVED_FROM))
+            {
+                changed.remove(rel);
+                removed.insert(rel);
+            }
+
+            else if (ev->mask & (IN_CREATE | IN_MOVED_TO | IN_CLOSE_WRITE))
+            {
+                removed.remove(rel);
+                changed.insert(rel);
+            }
+        }
+    }
+
+    if (overflow)
+        emit directoryChanged();
+    else
+    {
+        for (const auto &subtree : subtrees)
+            emit subtreeChanged(subtree);
+        if (!changed.isEmpty() || !removed.isEmpty())
+            emit filesChanged(changed.values(), removed.values());
+    }
+#endif
+}
@@ -0,0 +1,58 @@
+// Copyright (c) 2025 Manuel Schneider
+
+#pragma once
+#include <QDir>
+#include <QFileSystemWatcher>
+#include <QHash>
+#include <QObject>
+#include <QStringList>
+class QSocketNotifier;
+
+///
+/// Watches the snippet directory tree.
+///
+/// On Linux the watcher consumes the inotify event stream of every directory
+/// in the tree and reports the snippet files and directories that changed.
+/// Elsewhere, or if inotify is not available, only `directoryChanged` is
+/// emitted and a rescan is necessary.
+///
+/// All reported paths are relative to the root directory.
+///
+class SnippetWatcher : public QObject
+{
+    Q_OBJECT
+
+public:
+
+    SnippetWatcher(const QString &path, QObject *parent = nullptr);
+    ~SnippetWatcher() override;
+
+    /// Returns true if file level events are available.
+    bool isNative() const;
+
+signals:
+
+    /// Files in `changed` have been created or rewritten, files in `removed`
+    /// have been deleted or moved away. Emitted once per batch of events.
+    void filesChanged(const QStringList &changed, const QStringList &removed);
+
+    /// The directory at `path` appeared or disappeared, its subtree has to be rescanned.
+    void subtreeChanged(const QString &path);
+
+    /// The tree changed in an unknown way, a full rescan is necessary.
+    void directoryChanged();
+
+private:
+
+    QString absolutePath(const QString &relative_path) const;
+    void watch(const QString &relative_dir);  // Recursively
+    void unwatch(const QString &relative_dir);  // Recursively
+    void readEvents();
+
+    const QDir root;
+    int inotify_fd = -1;
+    QSocketNotifier *notifier = nullptr;
+    QHash<int, QString> watches;  // Watch descriptor -> relative dir
+    QFileSystemWatcher fallback;
+
+};
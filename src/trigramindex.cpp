@@ -0,0 +1,151 @@
+// Copyright (c) 2025 Manuel Schneider
+
+#include "trigramindex.h"
+#include <algorithm>
+#include <albert/item.h>
+using namespace albert;
+using namespace std;
+
+static inline quint32 trigram(const char *p)
+{
+    return quint32(uchar(p[0])) << 16 | quint32(uchar(p[1])) << 8 | quint32(uchar(p[2]));
+}
+
+static vector<quint32> trigrams(QByteArrayView text)
+{
+    vector<quint32> r;
+    if (text.size() >= 3)
+    {
+        r.reserve(text.size() - 2);
+        for (qsizetype i = 0; i + 3 <= text.size(); ++i)
+            r.push_back(trigram(text.data() + i));
+        sort(r.begin(), r.end());
+        r.erase(unique(r.begin(), r.end()), r.end());
+    }
+    return r;
+}
+
+TrigramIndex::TrigramIndex(const vector<Document> &documents, qsizetype memory_budget)
+{
+    // (trigram << 32 | id) pairs, sorted they form the posting lists
+    vector<quint64> pairs;
+    qsizetype usage = 0;
+
+    for (const auto &doc : documents)
+    {
+        const auto doc_usage = cost(doc.text);
+        if (usage + doc_usage > memory_budget)
+        {
+            ++skipped_;
+            continue;
+        }
+
+        const auto id = quint64(documents_.size());
+        for (const auto key : trigrams(doc.text))
+            pairs.push_back(quint64(key) << 32 | id);
+
+        usage += doc_usage;
+        text_size_ += doc.text.size();
+        documents_.push_back(doc);
+    }
+
+    sort(pairs.begin(), pairs.end());
+
+    postings_.reserve(pairs.size());
+    for (const auto pair : pairs)
+    {
+        const auto key = quint32(pair >> 32);
+        if (keys_.empty() || keys_.back() != key)
+        {
+            keys_.push_back(key);
+            offsets_.push_back(postings_.size());
+        }
+        postings_.push_back(quint32(pair));
+    }
+    offsets_.push_back(postings_.size());
+
+    keys_.shrink_to_fit();
+    offsets_.shrink_to_fit();
+}
+
+qsizetype TrigramIndex::cost(QByteArrayView text)
+{
+    // At most one trigram per byte, in a pair while building and in a posting list
+    const auto max_trigrams = max<qsizetype>(0, text.size() - 2);
+    return text.size() + max_trigrams * qsizetype(sizeof(quint64) + sizeof(quint32));
+}
+
+QByteArray TrigramIndex::normalize(const QString &text, qsizetype max_bytes)
+{
+    // A character takes at least one byte, lowercase the needed prefix only
+    auto utf8 = text.first(min(text.size(), max_bytes)).toLower().toUtf8();
+    if (utf8.size() > max_bytes)
+        utf8.truncate(max_bytes);
+    utf8.squeeze();
+    return utf8;
+}
+
+optional<vector<quint32>> TrigramIndex::match(const QString &query,
+                                             const vector<quint32> *candidates) const
+{
+    const auto q = query.trimmed().toLower().toUtf8();
+    const auto query_trigrams = trigrams(q);
+    if (query_trigrams.empty())
+        return {};
+
+    vector<quint32> results;
+    if (candidates)
+    {
+        for (const auto id : *candidates)
+            if (documents_[id].text.contains(q))
+                results.push_back(id);
+        return results;
+    }
+
+    // Posting lists of the query trigrams, shortest first
+    vector<pair<const quint32 *, const quint32 *>> lists;
+    for (const auto key : query_trigrams)
+    {
+        const auto it = lower_bound(keys_.begin(), keys_.end(), key);
+        if (it == keys_.end() || *it != key)
+            return results;
+        const auto k = it - keys_.begin();
+        lists.emplace_back(postings_.data() + offsets_[k], postings_.data() + offsets_[k + 1]);
+    }
+    sort(lists.begin(), lists.end(),
+         [](const auto &a, const auto &b){ return a.second - a.first < b.second - b.first; });
+
+    vector<quint32> ids(lists.front().first, lists.front().second);
+    for (auto l = next(lists.begin()); l != lists.end() && !ids.empty(); ++l)
+    {
+        vector<quint32> intersection;
+        set_intersection(ids.begin(), ids.end(), l->first, l->second,
+                         back_inserter(intersection));
+        ids = ::move(intersection);
+    }
+
+    for (const auto id : ids)
+        if (documents_[id].text.contains(q))
+            results.push_back(id);
+    return results;
+}
+
+vector<shared_ptr<Item>> TrigramIndex::search(const QString &query) const
+{
+    vector<shared_ptr<Item>> results;
+    if (const auto ids = match(query))
+        for (const auto id : *ids)
+            results.push_back(documents_[id].item);
+    return results;
+}
+
+const shared_ptr<Item> &TrigramIndex::item(quint32 id) const { return documents_[id].item; }
+
+qsizetype TrigramIndex::memoryUsage() const
+{
+    return text_size_
+           + qsizetype((keys_.size() + offsets_.size() + postings_.size()) * sizeof(quint32))
+           + qsizetype(documents_.size() * sizeof(Document));
+}
+
+qsizetype TrigramIndex::skipped() const { return skipped_; }
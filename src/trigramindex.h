@@ -0,0 +1,68 @@
+// Copyright (c) 2025 Manuel Schneider
+
+#pragma once
+#include <QByteArray>
+#include <QString>
+#include <memory>
+#include <optional>
+#include <vector>
+namespace albert { class Item; }
+
+///
+/// Immutable trigram index for substring search in the snippet contents.
+///
+/// Every byte trigram of the lowercase UTF-8 text references a slice of one
+/// flat posting array of document ids. A query looks up the candidates
+/// containing all of its trigrams and verifies them against the text.
+///
+/// Documents are indexed in order until the memory budget is exhausted. The
+/// budget covers the texts and the peak memory per trigram while building.
+///
+class TrigramIndex
+{
+public:
+
+    struct Document
+    {
+        std::shared_ptr<albert::Item> item;
+        QByteArray text;  // As returned by normalize()
+    };
+
+    TrigramIndex(const std::vector<Document> &documents, qsizetype memory_budget);
+
+    /// Returns the memory that indexing `text` takes at most, see the memory budget.
+    static qsizetype cost(QByteArrayView text);
+
+    /// Returns the lowercase UTF-8 representation of `text` truncated to `max_bytes`.
+    static QByteArray normalize(const QString &text, qsizetype max_bytes);
+
+    /// Returns the sorted ids of the documents whose text contains `query`.
+    ///
+    /// Returns nothing if `query` is shorter than a trigram. If set, only the
+    /// sorted `candidates` are verified, e.g. the matches of a query that
+    /// `query` extends.
+    std::optional<std::vector<quint32>> match(const QString &query,
+                                              const std::vector<quint32> *candidates = nullptr) const;
+
+    /// Returns the items whose text contains `query`.
+    std::vector<std::shared_ptr<albert::Item>> search(const QString &query) const;
+
+    /// Returns the item of the document `id`.
+    const std::shared_ptr<albert::Item> &item(quint32 id) const;
+
+    /// Returns the approximate memory used by the index in bytes.
+    qsizetype memoryUsage() const;
+
+    /// Returns the number of documents skipped due to the memory budget.
+    qsizetype skipped() const;
+
+private:
+
+    std::vector<quint32> keys_;  // Sorted trigrams
+    std::vector<quint32> offsets_;  // keys + 1
+    std::vector<quint32> postings_;
+    std::vector<Document> documents_;
+    qsizetype text_size_ = 0;
+    qsizetype skipped_ = 0;
+
+};
@@ -0,0 +1,162 @@
+// Copyright (c) 2025 Manuel Schneider
+
+#include "usagelog.h"
+#include <QDateTime>
+#include <QFile>
+#include <QSaveFile>
+#include <QUrl>
+#include <QtConcurrentRun>
+#include <albert/logging.h>
+#include <cmath>
+using namespace Qt::StringLiterals;
+using namespace std;
+
+static const auto flush_delay = 5000;  // ms
+static const auto flush_batch = 100;
+static const auto min_compaction_lines = 1000;
+static const auto min_weight = 0.01;  // Dropped on compaction
+
+static QString line(qint64 time, double weight, const QString &key)
+{
+    return u"%1 %2 %3\n"_s.arg(time).arg(weight, 0, 'g', 6)
+        .arg(QString::fromLatin1(QUrl::toPercentEncoding(key)));
+}
+
+UsageLog::UsageLog(const QString &path, double half_life_days):
+    path_(path),
+    lambda_(log(2.) / (half_life_days * 24 * 60 * 60))
+{
+    writer_.setMaxThreadCount(1);
+    flush_timer_.setSingleShot(true);
+    flush_timer_.setInterval(flush_delay);
+    QObject::connect(&flush_timer_, &QTimer::timeout, [this]{ flush(); });
+    QtConcurrent::run(&writer_, [this]{ load(); });
+}
+
+UsageLog::~UsageLog()
+{
+    flush();
+    writer_.waitForDone();
+}
+
+double UsageLog::decayed(const Usage &usage, qint64 now) const
+{ return usage.weight * exp(-lambda_ * double(max<qint64>(0, now - usage.time))); }
+
+void UsageLog::add(QHash<QString, Usage> &usages, const QString &key,
+                   double weight, qint64 time) const
+{
+    if (auto &u = usages[key]; time >= u.time)
+    {
+        u.weight = decayed(u, time) + weight;
+        u.time = time;
+    }
+    else  // Loaded after newer records
+        u.weight += weight * exp(-lambda_ * double(u.time - time));
+}
+
+void UsageLog::record(const QString &key)
+{
+    const auto now = QDateTime::currentSecsSinceEpoch();
+    {
+        lock_guard lock(mutex_);
+        add(usages_, key, 1., now);
+        pending_ << line(now, 1., key);
+        if (pending_.size() < flush_batch)
+        {
+            if (!flush_timer_.isActive())
+                flush_timer_.start();
+            return;
+        }
+    }
+    flush();
+}
+
+double UsageLog::score(const QString &key) const
+{
+    const auto now = QDateTime::currentSecsSinceEpoch();
+    lock_guard lock(mutex_);
+    if (const auto it = usages_.constFind(key); it != usages_.cend())
+        return decayed(*it, now);
+    return 0.;
+}
+
+void UsageLog::load()
+{
+    // Parse without the lock, score() must not wait for the disk
+    QHash<QString, Usage> usages;
+    qsizetype lines = 0;
+    if (QFile file(path_); file.open(QIODevice::ReadOnly | QIODevice::Text))
+        while (!file.atEnd())
+        {
+            const auto fields = file.readLine().trimmed().split(' ');
+            if (fields.size() != 3)
+            {
+                WARN << "Skipping malformed usage log line in" << path_;
+                continue;
+            }
+            add(usages, QUrl::fromPercentEncoding(fields[2]),
+                fields[1].toDouble(), fields[0].toLongLong());
+            ++lines;
+        }
+
+    // Merge the uses recorded meanwhile
+    lock_guard lock(mutex_);
+    for (auto it = usages_.cbegin(); it != usages_.cend(); ++it)
+        add(usages, it.key(), it->weight, it->time);
+    usages_ = ::move(usages);
+    log_lines_ += lines;
+    loaded_ = true;
+}
+
+void UsageLog::flush()
+{
+    flush_timer_.stop();
+
+    QStringList lines;
+    bool compact = false;
+    {
+        lock_guard lock(mutex_);
+        if (pending_.isEmpty())
+            return;
+
+        lines = ::exchange(pending_, {});
+        log_lines_ += lines.size();
+
+        // Requires the complete state, i.e. the log has been loaded
+        if (loaded_ && log_lines_ > min_compaction_lines && log_lines_ > 4 * usages_.size())
+        {
+            compact = true;
+            lines.clear();
+            const auto now = QDateTime::currentSecsSinceEpoch();
+            for (auto it = usages_.begin(); it != usages_.end();)
+            {
+                if (decayed(*it, now) < min_weight)
+                    it = usages_.erase(it);
+                else
+                {
+                    lines << line(it->time, it->weight, it.key());
+                    ++it;
+                }
+            }
+            log_lines_ = lines.size();
+        }
+    }
+
+    QtConcurrent::run(&writer_, [path=path_, lines, compact]
+    {
+        const auto data = lines.join(QString()).toUtf8();
+
+        if (compact)
+        {
+            QSaveFile file(path);
+            if (!file.open(QIODevice::WriteOnly) || file.write(data) != data.size() || !file.commit())
+                WARN << "Failed to compact usage log" << path << file.errorString();
+        }
+        else
+        {
+            QFile file(path);
+            if (!file.open(QIODevice::Append) || file.write(data) != data.size())
+                WARN << "Failed to append to usage log" << path << file.errorString();
+        }
+    });
+}
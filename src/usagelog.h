@@ -0,0 +1,57 @@
+// Copyright (c) 2025 Manuel Schneider
+
+#pragma once
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QThreadPool>
+#include <QTimer>
+#include <mutex>
+
+///
+/// Persistent, exponentially decayed usage counters.
+///
+/// Each use is appended as a line `<unix time> <weight> <percent encoded key>`
+/// to a log file. Appends are batched and written on a background thread
+/// without syncing to disk. When the log grows much larger than the number of
+/// keys it is compacted to one line per key holding the decayed weight.
+///
+/// Thread-safe.
+///
+class UsageLog
+{
+public:
+
+    UsageLog(const QString &path, double half_life_days);
+    ~UsageLog();
+
+    /// Records a use of `key` now.
+    void record(const QString &key);
+
+    /// Returns the decayed use count of `key`.
+    double score(const QString &key) const;
+
+private:
+
+    struct Usage
+    {
+        double weight = 0.;
+        qint64 time = 0;  // Unix time of the weight
+    };
+
+    double decayed(const Usage &usage, qint64 now) const;
+    void add(QHash<QString, Usage> &usages, const QString &key, double weight, qint64 time) const;
+    void load();
+    void flush();
+
+    const QString path_;
+    const double lambda_;  // Decay per second
+    mutable std::mutex mutex_;
+    QHash<QString, Usage> usages_;
+    QStringList pending_;
+    qsizetype log_lines_ = 0;
+    bool loaded_ = false;
+    QThreadPool writer_;  // Single thread, serializes the file access
+    QTimer flush_timer_;
+
+};